@@ -0,0 +1,106 @@
+//===- KernelCorpus.h -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file KernelCorpus.h
+/// \author Federico Iannucci
+/// \brief This file contains the corpus of kernels of the benchmarks: their
+///        lookup, the build and run of their mutants and the comparison of
+///        the outputs with the golden ones
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_BENCHMARK_KERNELCORPUS_H_
+#define INCLUDE_BENCHMARK_KERNELCORPUS_H_
+
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+#include <vector>
+
+namespace chimera {
+namespace bench {
+
+/// @brief A kernel of the corpus, a directory with:
+///        - kernel.cpp, the source mutated by chimera
+///        - driver.cpp, the main function calling the kernel and printing its
+///          outputs
+///        - conf.csv, the functions/operators configuration of the kernel
+///        - golden.txt, the output of the original kernel
+struct Kernel {
+  std::string name;      ///< Name of the directory
+  std::string directory; ///< Absolute path, with trailing pathSep
+
+  std::string getKernelPath() const { return directory + "kernel.cpp"; }
+  std::string getDriverPath() const { return directory + "driver.cpp"; }
+  std::string getConfPath() const { return directory + "conf.csv"; }
+  std::string getGoldenPath() const { return directory + "golden.txt"; }
+};
+
+/// @brief Find the kernels of a corpus, sorted by name
+/// @param corpusDirectory The directory of the kernel directories
+std::vector<Kernel> findKernels(const std::string &corpusDirectory);
+
+/// @brief The distance of an output from the golden one
+/// @details The outputs are compared token by token, on white spaces. The
+///          error is the mean absolute error of the numeric tokens, divided by
+///          the largest absolute golden value.
+struct OutputError {
+  OutputError() : comparable(false), identical(false), error(0) {}
+
+  bool comparable; ///< Same number of tokens and same non numeric tokens
+  bool identical;  ///< Same tokens
+  double error;    ///< Normalized mean error, if comparable
+};
+
+/// @brief Compare an output with the golden one
+OutputError compareOutput(llvm::StringRef output, llvm::StringRef golden);
+
+/// @brief Builds a kernel source with its driver and runs it
+class KernelRunner {
+public:
+  /// @param compiler The C++ compiler, by name or path
+  /// @param flags The flags of the compiler, as the ones of the approximate
+  ///        computing libraries the mutants use
+  /// @param timeout Seconds a run can last, 0 for no limit
+  KernelRunner(const std::string &compiler,
+               const std::vector<std::string> &flags, unsigned timeout);
+
+  /// @brief If the compiler has been found
+  bool isValid() const { return !this->compilerPath.empty(); }
+
+  /// @brief Build a source of the kernel and run it
+  /// @param kernel The kernel
+  /// @param sourcePath The kernel source, the original or a mutant
+  /// @param workDirectory The directory of the executable, of the build log
+  ///        (build.log) and of the output (output.txt)
+  /// @param output The standard output of the run
+  /// @return If it has been built and it exited with 0
+  bool buildAndRun(const Kernel &kernel, const std::string &sourcePath,
+                   const std::string &workDirectory, std::string &output) const;
+
+private:
+  std::string compilerPath;       ///< Absolute path of the compiler
+  std::vector<std::string> flags; ///< Compiler flags
+  unsigned timeout;               ///< Seconds a run can last
+};
+
+} // End chimera::bench namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_BENCHMARK_KERNELCORPUS_H_ */
@@ -0,0 +1,59 @@
+//===- SourceGenerator.h ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file SourceGenerator.h
+/// \author Federico Iannucci
+/// \brief This file contains the generator of the synthetic translation units
+///        of the benchmarks
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_BENCHMARK_SOURCEGENERATOR_H_
+#define INCLUDE_BENCHMARK_SOURCEGENERATOR_H_
+
+#include <string>
+
+namespace chimera {
+namespace bench {
+
+/// @brief The shape of a synthetic translation unit
+/// @details Each group has a float function, for FLAP and VPA, a loop
+///          function, for the loop perforation and AxDCT, and an integer
+///          function, for Adder. A function is omitted when its count is 0.
+struct SourceShape {
+  SourceShape()
+      : groups(20), floatExpressions(8), loops(2), loopDepth(2), addChains(4),
+        addChainLength(4) {}
+
+  unsigned groups;           ///< Number of function groups
+  unsigned floatExpressions; ///< Float expressions per float function
+  unsigned loops;            ///< Loop nests per loop function
+  unsigned loopDepth;        ///< Depth of each loop nest
+  unsigned addChains;        ///< Integer add chains per integer function
+  unsigned addChainLength;   ///< Operands of each add chain
+};
+
+/// @brief Generate a compilable C++ translation unit, the same for the same
+///        shape
+std::string generateSource(const SourceShape &shape);
+
+} // End chimera::bench namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_BENCHMARK_SOURCEGENERATOR_H_ */
@@ -0,0 +1,101 @@
+//===- EditScript.h ---------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file EditScript.h
+/// \author Federico Iannucci
+/// \brief This file contains the class EditScript
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_CORE_EDITSCRIPT_H_
+#define INCLUDE_CORE_EDITSCRIPT_H_
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace chimera {
+namespace mutant {
+
+/// @brief Replacement of length bytes of the original source at offset
+struct Edit {
+  size_t offset;            ///< Offset in the original source
+  size_t length;            ///< Number of replaced bytes
+  ::std::string replacement;  ///< Text in place of the replaced bytes
+};
+
+/**
+ * @brief A mutant as the list of edits to apply to the original source
+ * @details The edits are sorted by offset and don't overlap, so a mutant of a
+ *          large file costs only the size of its changes. The script can be
+ *          built edit by edit or as the difference between the original and
+ *          the mutated source, for example the buffer of a clang::Rewriter.
+ *
+ *          The serialized form is a sequence of records:
+ *          "<offset> <length> <replacement size>\n<replacement>\n"
+ */
+class EditScript {
+ public:
+  /// @brief Build the script turning original in mutated
+  /// @details The changed region is found trimming the common prefix and
+  ///          suffix, then its lines are diffed: each group of changed lines
+  ///          is an edit, trimmed of its common ends. So an insertion at the
+  ///          start of a function and a change in its body are two small
+  ///          edits. Above 1024 changed lines the region is a single edit.
+  static EditScript diff(::llvm::StringRef original, ::llvm::StringRef mutated);
+
+  /// @brief Add an edit, it must follow the previous ones
+  /// @return If the edit has been added, false if it overlaps the previous
+  ///         ones or its end overflows
+  bool addEdit(size_t offset, size_t length, ::llvm::StringRef replacement);
+
+  /// @brief The edits, sorted by offset
+  const ::std::vector<Edit> &getEdits() const { return this->edits; }
+  bool empty() const { return this->edits.empty(); }
+
+  /// @brief Apply the script
+  /// @param original The source the script has been built on
+  /// @param mutated It is set to the mutated source
+  /// @return If every edit is inside original, otherwise mutated is left
+  ///         untouched
+  bool apply(::llvm::StringRef original, ::std::string &mutated) const;
+
+  /// @brief Write the serialized script
+  void write(::llvm::raw_ostream &out) const;
+  /// @brief The serialized script
+  ::std::string str() const;
+  /// @brief Read a serialized script
+  /// @details The edits are checked to be sorted and not overlapping, apply()
+  ///          checks them against the original source.
+  /// @param data The serialized script
+  /// @param script It is set to the read script
+  /// @return If data is a well formed script
+  static bool read(::llvm::StringRef data, EditScript &script);
+
+ private:
+  ::std::vector<Edit> edits;  ///< Edits sorted by offset
+};
+
+}  // End chimera::mutant namespace
+}  // End chimera namespace
+
+#endif /* INCLUDE_CORE_EDITSCRIPT_H_ */
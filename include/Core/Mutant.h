@@ -26,11 +26,34 @@
 #ifndef INCLUDE_MUTANT_H_
 #define INCLUDE_MUTANT_H_
 
+#include <atomic>
+
 namespace chimera {
 namespace mutant {
 
 using IdType = unsigned int;
 
+/**
+ * @brief Thread safe allocator of mutant identifiers
+ * @details Identifiers are allocated in increasing order, Mutant #0 is
+ *          reserved so by default the first one is 1.
+ */
+class IdAllocator {
+ public:
+  explicit IdAllocator(IdType first = 1) : next(first) {}
+
+  /// @brief Allocate a new identifier
+  IdType allocate() { return this->next.fetch_add(1); }
+  /// @brief The identifier the next allocation will return, that is the
+  ///        number of allocated identifiers plus the first one
+  IdType peek() const { return this->next.load(); }
+  /// @brief Restart the allocation from first
+  void reset(IdType first = 1) { this->next.store(first); }
+
+ private:
+  ::std::atomic<IdType> next;  ///< Next identifier to allocate
+};
+
 /**
  * @brief Generic Mutant Class
  */
@@ -0,0 +1,131 @@
+//===- MutantReport.h -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantReport.h
+/// \author Federico Iannucci
+/// \brief This file contains the sinks of the mutants report
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_CORE_MUTANTREPORT_H_
+#define INCLUDE_CORE_MUTANTREPORT_H_
+
+#include "Core/Mutant.h"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+#include <string>
+
+namespace chimera {
+namespace mutant {
+
+/// @brief Formats of the mutants report
+enum ReportFormat {
+  CsvReport,    ///< report.csv: id,function,line,column,mutator,type
+  NdjsonReport, ///< report.ndjson: a JSON object per line
+  BinaryReport  ///< report.bin: reportBinaryMagic and the binary entries
+};
+
+/// @brief Magic number at the start of report.bin. Each entry follows as:
+///        u32 id, u32 line, u32 column, u32 type, u32 alias of,
+///        u16 function size, u16 mutator size, function, mutator; in the
+///        machine byte order
+const char reportBinaryMagic[8] = {'C', 'H', 'M', 'R', 'R', 'P', 'T', '2'};
+
+/// @brief An entry of the mutants report
+struct ReportEntry {
+  IdType id;               ///< Mutant id
+  ::std::string function;  ///< Name of the mutated function
+  unsigned line;           ///< Line of the matched node
+  unsigned column;         ///< Column of the matched node
+  ::std::string mutator;   ///< Identifier of the mutator
+  unsigned type;           ///< Mutator type
+  /// @brief The id of the identical mutant this match produced, 0 if the
+  ///        mutant is its own. An alias entry has the same id, report.csv
+  ///        leaves it out for aliases.csv.
+  IdType aliasOf;
+};
+
+/**
+ * @brief A destination of the mutants report
+ * @details The entries are buffered in memory and written when the sink is
+ *          closed, once per translation unit. A report file is written aside
+ *          and renamed on its path, so it appears complete or not at all. A
+ *          stream is written in blocks of whole entries of at most PIPE_BUF
+ *          bytes, so the entries appended by several processes to the same
+ *          pipe don't interleave.
+ */
+class ReportSink {
+ public:
+  virtual ~ReportSink() {}
+
+  /// @brief Open the destination of the report
+  /// @return If the destination has been opened
+  bool open();
+
+  /// @brief Add an entry
+  void write(const ReportEntry &entry) { this->format_(entry, this->buffer); }
+
+  /// @brief Write the buffered entries
+  /// @return If the entries have been written
+  bool close();
+
+  /// @brief Create a report file, written atomically on close
+  /// @param format The format of the entries
+  /// @param path The path of the report
+  static ::std::unique_ptr<ReportSink> createFile(ReportFormat format,
+                                                  const ::std::string &path);
+
+  /// @brief Create aliases.csv: the alias entries, with the columns of
+  ///        report.csv, written atomically on close
+  /// @param path The path of the report
+  static ::std::unique_ptr<ReportSink> createAliasFile(
+      const ::std::string &path);
+
+  /// @brief Create a report appended to path, for example a named pipe
+  /// @param format The format of the entries
+  /// @param path The path of the stream
+  static ::std::unique_ptr<ReportSink> createStream(ReportFormat format,
+                                                    const ::std::string &path);
+
+  /// @brief The usual file name of a report in format
+  static const char *getFileName(ReportFormat format);
+
+ protected:
+  ReportSink(const ::std::string &path, bool atomic)
+      : path(path), atomic(atomic), data(), buffer(data), file() {}
+
+  /// @brief Format an entry on out
+  virtual void format_(const ReportEntry &entry, ::llvm::raw_ostream &out) = 0;
+  /// @brief Data written before the first entry
+  virtual void header_(::llvm::raw_ostream &out) {}
+
+ private:
+  ::std::string path;                ///< Destination of the report
+  bool atomic;                       ///< If written aside and renamed
+  ::std::string data;                ///< Entries not yet written
+  ::llvm::raw_string_ostream buffer; ///< Stream on data
+  ::std::unique_ptr<::llvm::raw_fd_ostream> file; ///< The open destination
+};
+
+}  // End chimera::mutant namespace
+}  // End chimera namespace
+
+#endif /* INCLUDE_CORE_MUTANTREPORT_H_ */
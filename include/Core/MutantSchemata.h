@@ -0,0 +1,95 @@
+//===- MutantSchemata.h -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantSchemata.h
+/// \author Federico Iannucci
+/// \brief This file contains the class MutantSchemata
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_CORE_MUTANTSCHEMATA_H_
+#define INCLUDE_CORE_MUTANTSCHEMATA_H_
+
+#include "Core/Mutant.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chimera {
+namespace mutant {
+
+/// @brief Macro selecting the mutant in a schemata, 0 or undefined selects the
+///        original code
+const char *const schemataMacro = "CHIMERA_MUTANT";
+
+/**
+ * @brief A single source file containing all the mutants of a source
+ * @details Each mutant is stored as the range of lines it replaces in the
+ *          original source. When written, overlapping ranges are grouped and
+ *          every group is emitted as an #if/#elif chain on the schemataMacro
+ *          value, with the original lines in the #else branch.
+ *          The granularity is the line: the changed lines must not start
+ *          inside a multi-line comment or after a line continuation.
+ *          A range covering part of a preprocessor conditional is widened
+ *          to the whole conditional, so the emitted directives stay
+ *          balanced.
+ */
+class MutantSchemata {
+ public:
+  /// @brief Ctor
+  /// @param original The source code of the original file
+  explicit MutantSchemata(::llvm::StringRef original);
+
+  /// @brief Add a mutant, replacing the previous one with the same id
+  /// @param id The mutant id
+  /// @param code The source code of the mutant
+  /// @return If the mutant has been added, false if its changed lines have
+  ///         unbalanced preprocessor conditionals
+  bool addMutant(IdType id, ::llvm::StringRef code);
+
+  /// @brief The number of mutants in the schemata
+  size_t size() const { return this->hunks.size(); }
+
+  /// @brief Write the schemata
+  void write(::llvm::raw_ostream &out) const;
+
+ private:
+  /// @brief The lines [begin, end) of the original replaced by lines
+  struct Hunk {
+    size_t begin;
+    size_t end;
+    ::std::vector<::std::string> lines;
+  };
+
+  ::std::vector<::std::string> original;  ///< Original lines, with newlines
+  /// @brief For each original line that is a conditional directive, the
+  ///        lines of its opening #if and of its #endif, npos for the others
+  ::std::vector<::std::pair<size_t, size_t>> conditionals;
+  ::std::map<IdType, Hunk> hunks;         ///< Mutants by id
+};
+
+}  // End chimera::mutant namespace
+}  // End chimera namespace
+
+#endif /* INCLUDE_CORE_MUTANTSCHEMATA_H_ */
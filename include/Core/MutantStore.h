@@ -0,0 +1,154 @@
+//===- MutantStore.h --------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantStore.h
+/// \author Federico Iannucci
+/// \brief This file contains the storages of the generated mutants
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_CORE_MUTANTSTORE_H_
+#define INCLUDE_CORE_MUTANTSTORE_H_
+
+#include "Core/EditScript.h"
+#include "Core/Mutant.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace chimera {
+namespace mutant {
+
+/// @brief How the mutants of a source are saved in its output directory
+enum MutantStoreMode {
+  /// Each mutant as a full copy of the source, in <id>/<filename>
+  FullMutantStore,
+  /// The source once, in original/<filename>, and each mutant as its edit
+  /// script, in patches/<id>.edit
+  PatchMutantStore,
+  /// The source once, in original/<filename>, and the last edit script of
+  /// each mutant in mutants.pack, written on close and indexed by mutants.idx
+  PackMutantStore
+};
+
+/// @brief Where a mutant comes from, kept by the stores with an index
+struct MutantOrigin {
+  ::std::string mutator; ///< Identifier of the mutator
+  unsigned line;         ///< Line of the matched node, 0 if unknown
+  unsigned column;       ///< Column of the matched node, 0 if unknown
+};
+
+/// @brief Magic number at the start of mutants.idx
+const char packIndexMagic[8] = {'C', 'H', 'M', 'R', 'I', 'D', 'X', '1'};
+
+/// @brief Header of mutants.idx
+struct PackIndexHeader {
+  char magic[8];         ///< packIndexMagic
+  uint32_t recordSize;   ///< sizeof(PackIndexRecord)
+  uint32_t recordCount;  ///< Number of records, the highest id plus one
+};
+
+/**
+ * @brief Record of a mutant in mutants.idx
+ * @details The records follow the header, the one of mutant id is the id-th,
+ *          so the file can be mapped in memory and any mutant reached in
+ *          O(1). Integers are in the byte order of the machine that wrote
+ *          the index; a record of an id without mutant has id 0.
+ */
+struct PackIndexRecord {
+  uint64_t offset;      ///< Offset of the edit script in mutants.pack
+  uint32_t length;      ///< Length of the edit script
+  uint32_t id;          ///< Mutant id, 0 if there is no such mutant
+  uint8_t digest[16];   ///< MD5 of the edit script
+  uint32_t line;        ///< Line of the matched node, 0 if unknown
+  uint32_t column;      ///< Column of the matched node, 0 if unknown
+  char mutator[24];     ///< Mutator identifier, truncated and 0 padded
+};
+static_assert(sizeof(PackIndexHeader) == 16, "Unexpected index layout");
+static_assert(sizeof(PackIndexRecord) == 64, "Unexpected index layout");
+
+/**
+ * @brief Storage of the valid mutants of a source
+ * @details A mutant saved again with the same id, as the HOM ones, replaces
+ *          its previous version.
+ */
+class MutantStore {
+ public:
+  virtual ~MutantStore() {}
+
+  /// @brief Save a mutant
+  /// @param id The mutant id
+  /// @param script The mutant, as edits of the original source
+  /// @param origin Where the mutant comes from
+  /// @return If the mutant has been saved
+  virtual bool save(IdType id, const EditScript &script,
+                    const MutantOrigin &origin) = 0;
+
+  /// @brief Keep a mutant saved by a previous analysis with the same id and
+  ///        the same content, saving it only if the layout can't keep it
+  /// @param id The mutant id
+  /// @param script The mutant, as edits of the original source
+  /// @param origin Where the mutant comes from
+  /// @return If the mutant is in the store
+  virtual bool keep(IdType id, const EditScript &script,
+                    const MutantOrigin &origin) {
+    return this->save(id, script, origin);
+  }
+
+  /// @brief Remove a mutant saved by a previous analysis, if the layout
+  ///        keeps the mutants across the analyses
+  /// @param id The mutant id
+  virtual void remove(IdType id) {}
+
+  /// @brief Complete the storage, no mutant can be saved after it
+  /// @return If the storage has been completed
+  virtual bool close() { return true; }
+
+  /// @brief Create the storage of the mutants of a source
+  /// @param mode The storage layout
+  /// @param directory The output directory of the source, with trailing
+  ///        separator
+  /// @param filename The file name of the source
+  /// @param original The source code of the original source, it must outlive
+  ///        the store
+  /// @return The store, nullptr if it couldn't be created
+  static ::std::unique_ptr<MutantStore> create(MutantStoreMode mode,
+                                               const ::std::string &directory,
+                                               const ::std::string &filename,
+                                               ::llvm::StringRef original);
+
+  /// @brief Rebuild the source code of a saved mutant, whatever the layout
+  /// @param directory The output directory of the source, with trailing
+  ///        separator
+  /// @param filename The file name of the source
+  /// @param id The mutant id
+  /// @param code It is set to the source code of the mutant
+  /// @return If the mutant has been found
+  static bool materialize(const ::std::string &directory,
+                          const ::std::string &filename, IdType id,
+                          ::std::string &code);
+};
+
+}  // End chimera::mutant namespace
+}  // End chimera namespace
+
+#endif /* INCLUDE_CORE_MUTANTSTORE_H_ */
@@ -29,17 +29,35 @@
 
 #include "Utils.h"
 #include "Log.h"
+#include "Stats.h"
+#include "Core/EditScript.h"
 #include "Core/Mutant.h"
+#include "Core/MutantReport.h"
+#include "Core/MutantSchemata.h"
+#include "Core/MutantStore.h"
 #include "Core/MutationOperator.h"
+#include "Core/SlotManager.h"
+#include "Tooling/ASTCache.h"
+#include "Tooling/SyntaxChecker.h"
 
+#include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/Tooling/Tooling.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/ThreadPool.h"
 
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -54,15 +72,105 @@ class MatchFinder;
 
 namespace chimera
 {
+/// @brief Strategies to check the syntax of the mutants
+enum SyntaxCheckMode {
+    FullSyntaxCheck,     ///< Complete parse of each mutant
+    PreambleSyntaxCheck, ///< Reparse of the main file over a precompiled preamble
+    FunctionSyntaxCheck  ///< Parse of the mutated function body only
+};
+
+/// @brief A mutated function that can be checked together with other mutants
+///        of the same function, as renamed copies placed after the original
+/// @details The declarations the mutator inserted before the function are
+///          placed before each copy, renamed along with it.
+struct BatchableFunction {
+    unsigned insertOffset; ///< Offset in the original source after the function
+    std::string text;      ///< The mutated function
+    size_t nameOffset;     ///< Offset of the function name in text
+    size_t nameLength;     ///< Length of the function name
+    std::string declarations; ///< Declarations inserted before the function
+    /// Names declared by declarations, used in them and in text
+    std::vector<std::string> declaredNames;
+};
+
+/// @brief The functions a mutation operator is applied to
+/// @details The names are kept in a hash set. A name is looked up as the
+///          hasName matcher does: an unqualified name matches in any scope, a
+///          qualified one matches the last scopes, or the whole qualified
+///          name if it starts with "::". The patterns are tried after the
+///          names, the result is memoized per declaration.
+class FunctionFilter
+{
+public:
+    FunctionFilter() : all ( false ) {}
+
+    /// @brief Select all the functions
+    void selectAll() {
+        this->all = true;
+    }
+    /// @brief If all the functions are selected
+    bool isAll() const {
+        return this->all;
+    }
+
+    /// @brief Select the functions matching an entry of the FunOp
+    ///        configuration:
+    ///        - re:<regex>, a POSIX extended regular expression matching the
+    ///          whole qualified name, as dsp::.*_kernel
+    ///        - a glob with * and ?, as dsp::*_kernel, matching the whole
+    ///          qualified name if it contains "::", the name otherwise
+    ///        - a function name
+    /// @return If the entry is valid
+    bool add ( const std::string &function );
+    /// @brief Select also the functions of another filter
+    void merge ( const FunctionFilter &other );
+
+    /// @brief If a function is selected, the result is memoized: the filter
+    ///        has to be used on a single AST, by a single thread
+    bool matches ( const clang::FunctionDecl &function ) const;
+    /// @brief If a function is selected, without memoizing the result
+    bool selects ( const clang::FunctionDecl &function ) const;
+
+private:
+    /// @brief A compiled pattern
+    struct Pattern {
+        std::shared_ptr<llvm::Regex> regex; ///< Anchored regular expression
+        bool qualified;                     ///< If on the qualified name
+    };
+
+    bool all;                              ///< All the functions are selected
+    std::unordered_set<std::string> names; ///< Selected function names
+    std::vector<Pattern> patterns;         ///< Selected function patterns
+    /// @brief Results by declaration, each function is looked up once
+    mutable std::unordered_map<const clang::FunctionDecl *, bool> results;
+};
+
 /// @brief This class represent the context of mutation for a single .h/.cpp
 /// file.
+/// @details The mutant ids and the rewriters belong to the template, but two
+///          templates can't run at the same time in one process: the
+///          ClangTool traversal changes the working directory of the whole
+///          process and the ChimeraLogger indentation is global. The sources
+///          are analyzed in parallel by child processes.
 class MutationTemplate
 {
     // Usings
     using OperatorPtr = m_operator::MutationOperator *;
     using OperatorPtrMap = std::map<m_operator::IdType, OperatorPtr>;
+    /// @brief The functions each operator is applied to
+    using OperatorFunctionsMap = std::map<m_operator::IdType, FunctionFilter>;
 
 public:
+    /// @brief Function committing a checked mutant
+    /// @details It receives the result of the check, for a duplicate mutant
+    ///          the id of the identical mutant committed before it and, in
+    ///          the incremental analysis, the id the mutant kept from the
+    ///          previous analysis (0 otherwise). It returns the id of the
+    ///          committed mutant, 0 if it hasn't one.
+    using CommitFunction =
+        std::function<mutant::IdType ( bool passed, mutant::IdType aliasOf,
+                                       mutant::IdType keptId ) >;
+
     /// @brief Build a Mutation Template from :
     /// @param A clang::tooling::CompileCommand for the target
     /// @param target The path to the target file (relative or absolute)
@@ -74,10 +182,21 @@ public:
     const std::string &getTargetPath() const {
         return targetPath;
     }
-    const clang::StringRef getTargetFilename() {
+    const clang::StringRef getTargetFilename() const {
         return llvm::sys::path::filename ( this->targetPath );
     }
 
+    /// @brief The name of the target outputs, its file name unless set
+    std::string getTargetName() const {
+        return this->targetName.empty() ? this->getTargetFilename().str()
+               : this->targetName;
+    }
+    /// @brief Set the name of the target outputs, to tell apart sources with
+    ///        the same file name
+    void setTargetName ( const std::string &name ) {
+        this->targetName = name;
+    }
+
     void setTargetPath ( const std::string &target ) {
         this->targetPath = ::clang::tooling::getAbsolutePath ( target );
         ::chimera::log::ChimeraLogger::verbose ( "Setting target path: " +
@@ -90,8 +209,8 @@ public:
 
     /// @brief Return the Output directory (with trailing pathSep)
     /// @return The output directory for the target
-    std::string getTargetOutputDirectory() {
-        return this->outputDirectory + this->getTargetFilename().data() +
+    std::string getTargetOutputDirectory() const {
+        return this->outputDirectory + this->getTargetName() +
                ::chimera::fs::pathSep;
     }
 
@@ -119,13 +238,220 @@ public:
         this->generateMutants = val;
     }
 
+    mutant::MutantStoreMode getMutantStoreMode() const {
+        return this->mutantStoreMode;
+    }
+    /// @brief Set how the generated mutants are saved
+    void setMutantStoreMode ( mutant::MutantStoreMode mode ) {
+        this->mutantStoreMode = mode;
+    }
+
+    /// @brief Save a valid mutant in the store of the current analysis
+    /// @details A mutant kept unchanged from the previous incremental
+    ///          analysis isn't written again, if the store layout allows it
+    /// @param id The mutant id, an HOM mutant replaces its previous version
+    /// @param script The mutant, as edits of the original source
+    /// @param origin Where the mutant comes from
+    /// @return If the mutant has been saved
+    bool saveMutant ( mutant::IdType id, const mutant::EditScript &script,
+                      const mutant::MutantOrigin &origin ) {
+        if ( !this->mutantStore ) {
+            return false;
+        }
+        if ( this->unchangedIds.count ( id ) != 0 ) {
+            return this->mutantStore->keep ( id, script, origin );
+        }
+        return this->mutantStore->save ( id, script, origin );
+    }
+
+    bool isGenerateSchemata() {
+        return this->generateSchemata;
+    }
+    /// @brief Enable the generation of a single file with all the mutants
+    ///        selected by the CHIMERA_MUTANT macro, saved in
+    ///        <target_output_dir>/schemata/
+    void setGenerateSchemata ( bool val ) {
+        this->generateSchemata = val;
+    }
+
+    /// @brief The source code of the target the mutants are built on, only
+    ///        during an analysis
+    const std::string &getOriginalSource() const {
+        return this->originalSource;
+    }
+
+    /// @brief Add a valid mutant to the schemata of the current analysis
+    /// @param id The mutant id, an HOM mutant replaces its previous version
+    /// @param code The source code of the mutant
+    void addSchemataMutant ( mutant::IdType id, llvm::StringRef code ) {
+        if ( this->schemata && !this->schemata->addMutant ( id, code ) ) {
+            ::chimera::log::ChimeraLogger::warning (
+                "Mutant " + std::to_string ( id ) + " changes preprocessor "
+                "conditionals, it is left out of the schemata" );
+        }
+    }
+
+    SyntaxCheckMode getSyntaxCheckMode() const {
+        return this->syntaxCheckMode;
+    }
+    void setSyntaxCheckMode ( SyntaxCheckMode mode ) {
+        this->syntaxCheckMode = mode;
+    }
+
+    /// @brief Check the syntax of a mutant of the target
+    /// @details With PreambleSyntaxCheck the preamble of the target is
+    ///          precompiled once and shared by all the mutants checked with
+    ///          the same compile command.
+    ///          With FunctionSyntaxCheck the bodies of the functions other than
+    ///          functionName are skipped; if this check fails, or the function
+    ///          is unknown, the mutant is checked again on the whole file.
+    ///          When the function bodies are skipped, the full check of a
+    ///          mutant of functionName parses only the target bodies.
+    /// @param command The compile command for the target
+    /// @param code The source code of the mutant
+    /// @param functionName The qualified name of the mutated function
+    /// @return 0 if the mutant passes the check
+    int checkSyntax ( const clang::tooling::CompileCommand &command,
+                      llvm::StringRef code,
+                      const std::string &functionName = "" );
+
+    bool isIncremental() const {
+        return this->incremental;
+    }
+    /// @brief Enable the incremental analysis: the check results and the ids
+    ///        of the mutants are kept in incremental.txt, in the output
+    ///        directory of the target, keyed by a hash of the mutated function
+    ///        and of the mutation inside it. The function hash covers its
+    ///        text, the compile command and getIncrementalContext(). At the
+    ///        next analysis a mutant with a known key takes the kept result
+    ///        and id instead of being checked, and it isn't written again in
+    ///        a full or patch store if its content is unchanged, so only the
+    ///        mutants of the changed functions are parsed and saved. The new
+    ///        mutants get ids after the kept ones, the stored mutants that
+    ///        no longer exist are removed, the report is written as usual.
+    void setIncremental ( bool val ) {
+        this->incremental = val;
+    }
+
+    /// @brief What the mutants of any function depend on besides the
+    ///        function itself, in the incremental analysis: the target
+    ///        without the bodies of its functions, the MD5 of the included
+    ///        files, the check mode and the skipping of the bodies. It's
+    ///        computed once per analysis.
+    /// @param context The AST of the target
+    /// @return The digest, empty if an included file couldn't be read
+    const std::string &getIncrementalContext ( clang::ASTContext &context );
+
+    bool isDeduplicateMutants() {
+        return this->deduplicateMutants;
+    }
+    /// @brief Enable the deduplication of the mutants: a mutant identical to
+    ///        a previous one isn't checked nor saved, it gets no id and it's
+    ///        reported with the id of the previous one in aliases.csv, and as
+    ///        an alias entry in the other formats. Disabled by default, so the
+    ///        ids are the ones of the mutants without deduplication
+    void setDeduplicateMutants ( bool val ) {
+        this->deduplicateMutants = val;
+    }
+
+    unsigned getCheckBatchSize() const {
+        return this->checkBatchSize;
+    }
+    /// @brief Set the maximum number of mutants of the same function checked
+    ///        in a single parse, with 1 each mutant is checked alone
+    void setCheckBatchSize ( unsigned size ) {
+        this->checkBatchSize = size > 0 ? size : 1;
+    }
+
+    bool isSkipFunctionBodies() const {
+        return this->skipFunctionBodies;
+    }
+    /// @brief Let the parser skip the bodies of the functions that aren't
+    ///        selected by the FunOp configuration, both in the analysis and in
+    ///        the full syntax checks of the mutants. It has no effect if an
+    ///        operator is applied to all the functions.
+    void setSkipFunctionBodies ( bool val ) {
+        this->skipFunctionBodies = val;
+    }
+
+    /// @brief Get the AST of the target from an on-disk cache, instead of
+    ///        parsing it at each analysis
+    /// @details With a cache the function bodies are never skipped in the
+    ///          analysis: the cached AST is complete, so that it can serve any
+    ///          FunOp configuration.
+    /// @param cache The cache, nullptr to parse the target
+    void setASTCache ( std::shared_ptr<ASTCache> cache ) {
+        this->astCache = cache;
+    }
+
+    unsigned getValidationJobs() const {
+        return this->validationJobs;
+    }
+    /// @brief Set the number of threads checking the mutants, with 1 the
+    ///        mutants are checked in the matcher callbacks
+    void setValidationJobs ( unsigned jobs ) {
+        this->validationJobs = jobs > 0 ? jobs : 1;
+    }
+
+    /// @defgroup
+    /// @brief Functions to validate the mutants in parallel
+    /// @details The mutants are checked by a pool of validationJobs threads,
+    ///          while the commit functions are called on the calling thread in
+    ///          the same order of submission, so that mutant ids and report
+    ///          don't depend on the threads scheduling. At most
+    ///          4 * validationJobs checks are in flight at the same time.
+    ///          With a check batch size K greater than 1, consecutive mutants
+    ///          of the same function are checked up to K at a time: their
+    ///          renamed copies are placed after the original function and
+    ///          parsed once; if the parse fails, the batch is bisected down to
+    ///          the single mutants, checked on the whole mutated source.
+    /// @{
+
+    /// @brief Submit the check of a mutant
+    /// @param command The compile command for the target
+    /// @param script The mutant, as edits of the original source
+    /// @param functionName The qualified name of the mutated function
+    /// @param scope The operator and the mutator the check time is
+    ///        accounted to
+    /// @param commit Function called with the result of the check
+    /// @param deduplicable If the mutant has its own id, so that an identical
+    ///        one can be reported as its alias
+    /// @param batchable The mutated function, if the mutant can be checked in
+    ///        batch
+    /// @param incrementalKey The key of the mutant in the incremental
+    ///        analysis, empty if its result can't be kept
+    void submitCheck ( const clang::tooling::CompileCommand &command,
+                       std::shared_ptr<const mutant::EditScript> script,
+                       const std::string &functionName,
+                       const stats::PhaseScope &scope,
+                       CommitFunction commit, bool deduplicable = false,
+                       std::shared_ptr<const BatchableFunction> batchable =
+                           nullptr,
+                       const std::string &incrementalKey = "" );
+    /// @brief Wait for all the submitted checks and commit them
+    void waitChecks();
+
+    /// @}
+
+    /// @brief Set the formats of the report files, report.csv by default
+    void setReportFormats ( const std::vector<mutant::ReportFormat> &formats ) {
+        this->reportFormats = formats;
+    }
+    /// @brief Set a path, as a named pipe, to which the report is appended
+    ///        as NDJSON at the end of each analysis. Empty to disable it
+    void setReportPipe ( const std::string &path ) {
+        this->reportPipe = path;
+    }
+
     /// @defgroup
-    /// @brief Functions to manage the mutation template's report stream
+    /// @brief Functions to manage the mutation template's report sinks
+    /// @details The entries are buffered and written when the report is
+    ///          closed, at the end of the analysis.
     /// @{
 
-    bool openReportStream ( const char * );
-    std::ostream &getReportStream();
-    void closeReportStream();
+    bool openReport();
+    void addReportEntry ( const mutant::ReportEntry &entry );
+    bool closeReport();
 
     /// @}
 
@@ -156,20 +482,50 @@ public:
     /// @return ClangTool.run return value.
     int analyze ( const chimera::conf::FunOpConfMap & );
 
-    // Public member
-    /// @brief A counter for the created mutants. It'll contain the total number
-    /// after an analysis.
+    /// @brief The allocator of the mutant ids. After an analysis the next id
+    ///        is the total number of mutants plus one, unless the incremental
+    ///        analysis kept ids above it.
     ///        It starts from 1. Mutant #0 is reserved.
-    mutant::IdType mutantCounter;
+    mutant::IdAllocator &getMutantIdAllocator() {
+        return this->mutantIds;
+    }
+
+    /// @brief The rewriters of the mutants of the current analysis
+    SlotManager<mutant::IdType, clang::Rewriter> &getRewriterManager() {
+        return this->rwManager;
+    }
 
 private:
+    struct PendingCheck;
+    struct CommittedMutant;
+    /// @brief A mutant in the incremental analysis
+    struct KeptMutant {
+        bool passed;         ///< If the mutant passed the check
+        mutant::IdType id;   ///< The mutant id, 0 if it hasn't one
+        std::string content; ///< MD5 of the stored mutant, "-" if not stored
+    };
+
     void initMutantIds_();
+    void addFunctions_ ( OperatorFunctionsMap &,
+                         const ::std::vector<m_operator::IdType> &,
+                         const ::std::string & );
     void addMatchers_ ( ::clang::ast_matchers::MatchFinder &,
-                        const m_operator::IdType &, const std::string & = "" );
-    void addMatchers_ ( ::clang::ast_matchers::MatchFinder &,
-                        const ::std::vector<m_operator::IdType> &,
-                        const ::std::string & );
+                        const OperatorFunctionsMap & );
     int run ( clang::ast_matchers::MatchFinder & );
+    int runOnCachedAST_ ( clang::ast_matchers::MatchFinder & );
+    bool saveSchemata_();
+    std::string getIncrementalPath_() const;
+    void loadIncremental_();
+    bool saveIncremental_();
+    std::string getMutantDigest_ ( const mutant::EditScript & ) const;
+    mutant::IdType keepMutantId_ ( const std::string &key,
+                                   const std::string &content );
+    void removeStaleMutants_();
+    void commitChecks_ ( size_t window );
+    void flushBatch_();
+    void scheduleChecks_ ( std::vector<std::shared_ptr<PendingCheck>> );
+    void checkBatch_ ( const std::vector<std::shared_ptr<PendingCheck>> &,
+                       size_t begin, size_t end );
 
     ::clang::tooling::CompileCommand
     compileCommand;               ///< Compile command for this target.
@@ -180,15 +536,79 @@ private:
 
     ::std::string
     targetPath; /**< The mutation template target: path to source file */
+    std::string targetName; ///< Name of the target outputs, if not its file name
     OperatorPtrMap
     operators; /**< The mutation operators to apply to the target */
 
     bool generateMutantsReport; ///< If mutants report has to be save
     bool generateMutants;       ///< If mutants have to be saved.
+    bool generateSchemata;      ///< If the mutants schemata has to be saved
+    mutant::MutantStoreMode mutantStoreMode; ///< How the mutants are saved
+    /// @brief The store of the current analysis, if mutants are generated
+    std::unique_ptr<mutant::MutantStore> mutantStore;
+    /// @brief The schemata of the current analysis
+    std::unique_ptr<mutant::MutantSchemata> schemata;
+    SyntaxCheckMode syntaxCheckMode; ///< How the mutants are checked
+    unsigned validationJobs;         ///< Number of threads checking mutants
+    unsigned checkBatchSize;         ///< Max mutants checked in a single parse
+    bool deduplicateMutants;         ///< If identical mutants are merged
+    bool incremental;                ///< If the check results are kept
+    /// @brief Mutants of the previous analysis, by incremental key
+    std::unordered_map<std::string, KeptMutant> previousChecks;
+    /// @brief Mutants of the current analysis, by incremental key
+    std::unordered_map<std::string, KeptMutant> currentChecks;
+    unsigned reusedChecks; ///< Checks taken from the previous analysis
+    /// @brief Ids of the stored mutants of the previous analysis
+    std::set<mutant::IdType> previousIds;
+    /// @brief Ids of the mutants committed by the current analysis
+    std::set<mutant::IdType> committedIds;
+    /// @brief The first id that can be kept, the lower ones are reserved
+    mutant::IdType firstKeptId;
+    /// @brief Ids kept from the previous analysis
+    std::unordered_set<mutant::IdType> keptIds;
+    /// @brief Kept ids whose stored mutant hasn't changed
+    std::unordered_set<mutant::IdType> unchangedIds;
+    /// @brief getIncrementalContext() of the current analysis, once computed
+    std::string incrementalContext;
+    /// @brief MD5 of the original source of the current analysis
+    std::string sourceDigest;
+    bool skipFunctionBodies;         ///< If non target bodies are skipped
+    /// @brief The functions whose bodies are parsed during the current
+    ///        analysis, all if null
+    std::shared_ptr<const FunctionFilter> bodyFilter;
+    std::shared_ptr<ASTCache> astCache; ///< Cache of the ASTs, if any
+    /// @brief The mutants of the current analysis by MD5 of their edit script
+    std::map<std::string, std::shared_ptr<CommittedMutant>> mutantDigests;
+    /// @brief Source code of the target during the analysis, the mutants are
+    ///        edit scripts on it
+    std::string originalSource;
+
+    /// @brief Idle preamble checkers of the current analysis, keyed by the
+    ///        command line since mutators can add their own compile commands.
+    ///        A checker is used by one thread at a time.
+    std::map<std::vector<std::string>,
+        std::vector<std::unique_ptr<PreambleSyntaxChecker>>> preambleCheckers;
+    std::mutex preambleCheckersMutex; ///< Protects preambleCheckers
+
+    /// @brief Pool of the validation threads, only during an analysis
+    std::unique_ptr<llvm::ThreadPool> validationPool;
+    /// @brief Checks submitted and not yet committed, in submission order
+    std::deque<std::shared_ptr<PendingCheck>> pendingChecks;
+    /// @brief Batchable checks not yet scheduled, they are also pending
+    std::vector<std::shared_ptr<PendingCheck>> openBatch;
+
+    mutant::IdAllocator mutantIds; ///< Ids of the created mutants
+    /// @brief Ids reserved for the HOM operators
+    SlotManager<m_operator::IdType, mutant::IdType> idManager;
+    /// @brief Rewriters of the mutants, HOM ones are reserved on their ids
+    SlotManager<mutant::IdType, clang::Rewriter> rwManager;
 
     ::std::string outputDirectory; ///< Output directory in which write outputs,
     ///it's saved as absolute path
-    ::std::ofstream reportStream;
+    std::vector<mutant::ReportFormat> reportFormats; ///< Formats of the report
+    std::string reportPipe; ///< Path the NDJSON report is appended to
+    /// @brief Sinks of the report of the current analysis
+    std::vector<std::unique_ptr<mutant::ReportSink>> reportSinks;
 };
 } // End chimera namespace
 
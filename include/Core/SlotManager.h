@@ -0,0 +1,147 @@
+//===- SlotManager.h --------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file SlotManager.h
+/// \author Federico Iannucci
+/// \brief This file contains the class SlotManager
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_CORE_SLOTMANAGER_H_
+#define INCLUDE_CORE_SLOTMANAGER_H_
+
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace chimera {
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief    This class manages the creation and deletion of rewriter objects
+/// @details  It works with a reservation mechanism:
+///            - a slot can be reserved, when the slot is required a rewriter is
+///            (eventually created and)
+///              returned,
+///            - if the slot doesn't exist a local over-writtable slot is used.
+///            The max number of local
+///              slots is given by \tparam localSlots, the max pallelisms in
+///              using the Rewriters managed by this
+///              class.
+/// @tparam   ContentType It must have a ctor without arguments
+/// FIXME Generalize it
+template <typename IdType, typename ContentType, int localSlots = 1>
+class SlotManager {
+  using SlotType = ::std::unique_ptr<ContentType>;
+
+public:
+  SlotManager() {}
+
+  /// @brief Try to reserve a slot, eg if you knew you're going to use it
+  /// @param toReserve Which slot should be reserved
+  /// @return bool If the reservation succeeds
+  bool reserve(IdType toReserve) {
+    auto retval = this->slots.insert(std::pair<IdType, SlotType>(
+        toReserve, ::std::unique_ptr<ContentType>(nullptr)));
+    DEBUG_WITH_TYPE("slot_manager", ::llvm::dbgs()
+                                        << "Reserving id:" << toReserve
+                                        << ".Operation: " << retval.second
+                                        << "\n");
+    return retval.second;
+  }
+
+  /// @brief Set a slot, differs from reserve because it also fills the slot
+  /// @param toReserve Which slot should be reserved
+  /// @param content The content of the slot
+  /// @return bool If the reservation succeeds
+  bool setSlot(IdType toReserve, const ContentType &content) {
+    auto retval = this->slots.insert(std::pair<IdType, SlotType>(
+        toReserve, ::std::unique_ptr<ContentType>(new ContentType(content))));
+    return retval.second;
+  }
+
+  /// @brief Try to reserve a slot using the local slot if it is valid.
+  /// @return bool If the reservation succeeds
+  bool reserveLocalSlot() {
+    // Check localSlot
+    if (this->localSlot.second) {
+      auto retval = this->slots.insert(::std::move(localSlot));
+      return retval.second;
+    }
+    return false;
+  }
+
+  /// @brief Try to release a previously reserved slot
+  /// @param toRelease
+  /// @return bool If the release succeeds
+  bool release(IdType toRelease) { return this->slots.erase(toRelease) == 1; }
+
+  /// @brief Retrieve a reserved slot if exists
+  /// @param slotId
+  /// @param content
+  /// @return bool If it exist
+  bool getReservedSlot(IdType slotId, ContentType &content) {
+    try {
+      content = *(this->slots.at(slotId));
+      return true;
+    } catch (const std::out_of_range &oor) { // Not present
+      return false;
+    }
+  }
+
+  /// @brief It creates the content of a slot, of a local one if wasn't reserved
+  /// or of the reserved one.
+  ///        If the content of the reserved slot already exist, it returns it.
+  /// @param mngr
+  /// @param lang
+  /// @param wasReserved If the slot was reserved
+  /// @return Rewriter A rewriter
+  template <typename... Args>
+  ContentType &getSlot(IdType slot, bool &wasReserved, Args &&... args) {
+    wasReserved = true;
+    try {
+      // Try to access the object, seeing if manages an object
+      if (!this->slots.at(slot)) {
+        // Create one
+        this->slots.at(slot)
+            .reset(new ContentType(::std::forward<Args>(args)...));
+      }
+
+      return *(this->slots.at(slot));
+    } catch (const std::out_of_range &oor) {
+      wasReserved = false;
+      // Renew the localSlot
+      localSlot.first = slot;
+      localSlot.second.reset(new ContentType(::std::forward<Args>(args)...));
+      return *localSlot.second;
+    }
+  }
+
+private:
+  // Each rewriter is associated with a key, in this case the mutantId
+  ::std::map<IdType, SlotType> slots;
+  ::std::pair<IdType, SlotType> localSlot; // Local slot
+};
+
+} // End chimera namespace
+
+#endif /* INCLUDE_CORE_SLOTMANAGER_H_ */
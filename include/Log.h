@@ -28,8 +28,11 @@
 
 #define ELPP_NO_DEFAULT_LOG_FILE            ///< Disable default logs folder.
 #define ELPP_DISABLE_DEFAULT_CRASH_HANDLING ///< Disable crash handling
+#define ELPP_THREAD_SAFE                    ///< Mutants are checked by threads
 #include "lib/easylogging++.h"
 
+#include <atomic>
+
 namespace chimera {
 namespace log {
   // FIXME Delete this intermediate class?
@@ -60,12 +63,27 @@ public:
   }
   static void resetActualVLevel() { actualVLevel = 0; }
   static void incrActualVLevel() {
-    actualVLevel = actualVLevel < 9 ? actualVLevel + 1 : 9;
+    VerboseLevel level = actualVLevel;
+    while (!actualVLevel.compare_exchange_weak(level,
+                                               level < 9 ? level + 1 : 9)) {
+    }
   }
 
   static void decrActualVLevel() {
-    actualVLevel = actualVLevel > 0 ? actualVLevel - 1 : 0;
+    VerboseLevel level = actualVLevel;
+    while (!actualVLevel.compare_exchange_weak(level,
+                                               level > 0 ? level - 1 : 0)) {
+    }
+  }
+
+  /// @brief If a verbose message of vlevel would be logged
+  /// @details It doesn't build anything, use it (or CHIMERA_VERBOSE) to skip
+  ///          the formatting of the discarded messages
+  static bool isVerboseEnabled(VerboseLevel vlevel) {
+    return verboseEnabled && VLOG_IS_ON(vlevel);
   }
+  /// @brief If a verbose message of the actual level would be logged
+  static bool isVerboseEnabled() { return isVerboseEnabled(actualVLevel); }
 
   /// @brief Log a message for the Verbose level
   ///
@@ -139,9 +157,35 @@ public:
 private:
   static const char *loggerName;
   static el::Configurations configurator;
-  static VerboseLevel actualVLevel;
+  /// @brief Indentation level of the verbose messages, the validation
+  ///        threads read it while the main thread changes it
+  static std::atomic<VerboseLevel> actualVLevel;
+  static bool verboseEnabled; ///< If initVerbose has been called
 };
 }
 }
 
+/// @brief Log a verbose message in the actual level, msg is evaluated only if
+///        the verbose output is enabled
+#define CHIMERA_VERBOSE(msg)                                                   \
+  do {                                                                         \
+    if (::chimera::log::ChimeraLogger::isVerboseEnabled()) {                   \
+      ::chimera::log::ChimeraLogger::verbose(msg);                             \
+    }                                                                          \
+  } while (0)
+
+/// @brief As CHIMERA_VERBOSE, then increment the actual level
+#define CHIMERA_VERBOSE_AND_INCR(msg)                                          \
+  do {                                                                         \
+    CHIMERA_VERBOSE(msg);                                                      \
+    ::chimera::log::ChimeraLogger::incrActualVLevel();                         \
+  } while (0)
+
+/// @brief As CHIMERA_VERBOSE, after decrementing the actual level
+#define CHIMERA_VERBOSE_PRE_DECR(msg)                                          \
+  do {                                                                         \
+    ::chimera::log::ChimeraLogger::decrActualVLevel();                         \
+    CHIMERA_VERBOSE(msg);                                                      \
+  } while (0)
+
 #endif /* SRC_INCLUDE_LOG_H_ */
@@ -62,7 +62,7 @@ class MutatorLoopPerforation2 : public chimera::mutator::Mutator
                     "mutator_loop_perforation_operator", // String identifier
                     "loop perforation", // Description
                     1,
-                    true),cond(nullptr),init(nullptr),opId(0) { }
+                    true),opId(0) { }
     virtual clang::ast_matchers::StatementMatcher getStatementMatcher() override; // Need to override this method, first part of matching rules
     virtual bool match ( const ::chimera::mutator::NodeType &node ) override; // Also this one, second part of matching rules
     virtual bool getMatchedNode ( const chimera::mutator::NodeType &,
@@ -73,12 +73,7 @@ class MutatorLoopPerforation2 : public chimera::mutator::Mutator
 
     virtual void onCreatedMutant(const ::std::string &mutantPath) override;
   private: 
-    const ::clang::BinaryOperator *cond; // < Retrive ForStmt condition  
-    const ::clang::BinaryOperator *init; 
     unsigned int opId; //< Counter to keep tracks of done mutations
-    const ::clang::UnaryOperator *inc; // < Retrive ForStmt increment  
-    const ::clang::BinaryOperator *binc; // < Retrive ForStmt increment in case of binary increment
-    const ::clang::BinaryOperator *bas; // < Retrive ForStmt increment in case of binary increment
   ::std::vector<MutationInfo> mutationsInfo;  ///< It maintains info about mutations, in order to be saved
 };
 
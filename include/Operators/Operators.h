@@ -35,6 +35,24 @@
 #include "Operators/Adder/Operators.h"
 #include "Operators/AxDCT/Operators.h"
 
+#include <vector>
 
+namespace chimera
+{
+/// @brief Create the mutation operators shipped with Chimera
+/// @return the operators, in registration order
+inline std::vector<m_operator::MutationOperatorPtr> getOperators()
+{
+  std::vector<m_operator::MutationOperatorPtr> operators;
+  operators.push_back(::chimera::flapmutator::getFLAPOperator());
+  operators.push_back(::chimera::vpamutator::getVPAOperator());
+  operators.push_back(::chimera::vpa_nmutator::getVPANOperator());
+  operators.push_back(::chimera::perforation::getPerforationFirstOperator());
+  operators.push_back(::chimera::perforation::getPerforationSecondOperator());
+  operators.push_back(::chimera::adder::getAdderOperator());
+  operators.push_back(::chimera::axdct::getAxDCTOperator());
+  return operators;
+}
+}  // End namespace chimera
 
 #endif /* INCLUDE_OPERATORS_OPERATORS_H */
@@ -0,0 +1,321 @@
+//===- Stats.h --------------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file Stats.h
+/// \author Federico Iannucci
+/// \brief This file contains the instrumentation of the chimera phases:
+///        aggregated times and trace spans
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_STATS_H_
+#define INCLUDE_STATS_H_
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace chimera {
+namespace stats {
+
+/// @brief Accumulated time of a phase
+struct PhaseTime {
+  PhaseTime() : wall(0), cpu(0), count(0) {}
+
+  double wall;    ///< Wall clock seconds
+  double cpu;     ///< CPU seconds of the thread running the phase
+  uint64_t count; ///< Number of times the phase has run
+};
+
+/// @brief The operator and the mutator a phase is accounted to
+struct PhaseScope {
+  std::string operatorId; ///< Operator identifier
+  std::string mutatorId;  ///< Mutator identifier
+};
+
+/// @brief Counted outcomes of the matchers of a mutator
+enum MatcherCounter {
+  CallbackCounter,  ///< Coarse grain matches, calls of the matcher callback
+  FineMatchCounter, ///< Fine grain matches, Mutator::match passed
+  EditCounter,      ///< Mutations that changed the source
+  PassedCounter,    ///< Mutants that passed the check
+  FailedCounter,    ///< Mutants that failed the check
+  DuplicateCounter, ///< Mutants identical to a previous one
+  MatcherCounterCount
+};
+
+/// @brief The counters of a mutator
+struct MatcherCounters {
+  MatcherCounters() : values() {}
+
+  uint64_t values[MatcherCounterCount]; ///< By MatcherCounter
+};
+
+/// @brief Wall and thread CPU clocks, started at construction
+class Stopwatch {
+public:
+  Stopwatch();
+  /// @brief The time since the construction
+  PhaseTime elapsed() const;
+  /// @brief The wall clock at the construction
+  std::chrono::steady_clock::time_point getWallStart() const {
+    return this->wallStart;
+  }
+
+private:
+  std::chrono::steady_clock::time_point wallStart; ///< Wall clock at start
+  double cpuStart; ///< Thread CPU seconds at start
+};
+
+/**
+ * @brief The times of the phases of a run, aggregated per source, operator
+ *        and mutator
+ * @details The phases of a source (the whole source, compile database
+ *          lookup, preprocessing, parse, matcher traversal) have empty
+ *          operator and mutator. The traversal includes the matcher
+ *          callbacks, so the mutator phases (callback, match, mutate, check,
+ *          save, onCreatedMutant) are also part of it when the mutants are
+ *          checked in the callbacks. A callback includes the match and the
+ *          mutate of its mutants. The time the traversal spends running
+ *          the checks in place, or waiting for the validation threads, is
+ *          also accounted to the source as "check wait".
+ *          The registry also counts the outcomes of the matchers of each
+ *          mutator, see MatcherCounter.
+ *          Times and counters are disabled by default, it is thread safe.
+ */
+class StatsRegistry {
+public:
+  /// @brief The registry of the process
+  static StatsRegistry &get();
+
+  bool isEnabled() const { return this->enabled.load(); }
+  void setEnabled(bool val) { this->enabled.store(val); }
+  bool isCountingEnabled() const { return this->counting.load(); }
+  void setCountingEnabled(bool val) { this->counting.store(val); }
+  /// @brief Drop the recorded times and counters, as the ones inherited by a
+  ///        forked process
+  void clear();
+
+  /// @brief Add a run of a phase
+  /// @param source The source file
+  /// @param operatorId The operator identifier, empty for a source phase
+  /// @param mutatorId The mutator identifier, empty for a source phase
+  /// @param phase The phase name
+  /// @param time The time of the run
+  void addTime(const std::string &source, const std::string &operatorId,
+               const std::string &mutatorId, const std::string &phase,
+               const PhaseTime &time);
+
+  /// @brief Count an outcome of the matchers of a mutator, if counting is
+  ///        enabled
+  void count(const std::string &source, const std::string &operatorId,
+             const std::string &mutatorId, MatcherCounter counter) {
+    if (this->counting.load()) {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      ++this->counters[source][operatorId][mutatorId].values[counter];
+    }
+  }
+
+  /// @brief The time of a phase of a source, summed on its operators and
+  ///        mutators for a mutator phase
+  PhaseTime getPhaseTime(const std::string &source,
+                         const std::string &phase) const;
+  /// @brief The counters of a source, summed on its operators and mutators
+  MatcherCounters getCounters(const std::string &source) const;
+
+  /// @brief Write the counters as CSV lines:
+  ///        source,operator,mutator,callbacks,fine_matches,edits,passed,
+  ///        failed,duplicates; the source is quoted
+  void writeCounters(llvm::raw_ostream &out) const;
+  /// @brief Add the counters written by writeCounters in another process
+  /// @return If all the lines have been read
+  bool readCounters(llvm::StringRef csv);
+  /// @brief Write the counters of each mutator, summed on the sources, as a
+  ///        table
+  void printCounters(llvm::raw_ostream &out) const;
+
+  /// @brief Write the sources as members of a JSON object, without braces
+  /// @return If at least a source has been written
+  bool writeSources(llvm::raw_ostream &out) const;
+
+  /// @brief Write a JSON report {"sources": {...}}
+  /// @param path The report path
+  /// @param fragments Sources written by writeSources in other processes
+  /// @return If the report has been written
+  bool writeReport(const std::string &path,
+                   const std::vector<std::string> &fragments =
+                       std::vector<std::string>()) const;
+
+private:
+  StatsRegistry() : enabled(false), counting(false) {}
+
+  /// @brief The phases by name
+  using PhaseMap = std::map<std::string, PhaseTime>;
+  /// @brief The phases of a source and of its mutators
+  struct SourceStats {
+    PhaseMap phases; ///< Source phases
+    /// Mutators phases, by operator and mutator
+    std::map<std::string, std::map<std::string, PhaseMap>> operators;
+  };
+
+  /// @brief Counters by source, operator and mutator
+  using CounterMap = std::map<
+      std::string,
+      std::map<std::string, std::map<std::string, MatcherCounters>>>;
+
+  std::atomic<bool> enabled;                   ///< If the times are recorded
+  std::atomic<bool> counting;                  ///< If the counters are kept
+  mutable std::mutex mutex;                    ///< Protects sources, counters
+  std::map<std::string, SourceStats> sources;  ///< Times by source
+  CounterMap counters;                         ///< Matcher counters
+};
+
+/// @brief An argument of a trace event
+using TraceArg = std::pair<const char *, std::string>;
+
+/**
+ * @brief The spans of a run in the Chrome Trace Event format, as complete
+ *        ("X") events, viewable in chrome://tracing or Perfetto
+ * @details The events are formatted when they are added and kept in memory
+ *          until the trace is written. The threads are numbered in order of
+ *          appearance, the one enabling the recorder is the main one.
+ *          The timestamps are microseconds of the steady clock, so the
+ *          events of forked processes can be merged in the same trace.
+ *          The recorder is disabled by default, it is thread safe.
+ */
+class TraceRecorder {
+public:
+  /// @brief The recorder of the process
+  static TraceRecorder &get();
+
+  bool isEnabled() const { return this->enabled.load(); }
+  /// @brief Enable or disable the recorder, the calling thread becomes the
+  ///        main one
+  void setEnabled(bool val);
+  /// @brief Drop the recorded spans, as the ones inherited by a forked
+  ///        process; the calling thread becomes the main one
+  void clear();
+
+  /// @brief Add a span
+  /// @param name The span name
+  /// @param start The start of the span
+  /// @param wall The duration of the span, in seconds
+  /// @param args The arguments shown with the span
+  void addSpan(const char *name, std::chrono::steady_clock::time_point start,
+               double wall, const std::vector<TraceArg> &args);
+
+  /// @brief Write the events of this process, comma separated
+  /// @return If at least an event has been written
+  bool writeEvents(llvm::raw_ostream &out) const;
+
+  /// @brief Write a JSON trace {"traceEvents": [...]}
+  /// @param path The trace path
+  /// @param fragments Events written by writeEvents in other processes
+  /// @return If the trace has been written
+  bool writeTrace(const std::string &path,
+                  const std::vector<std::string> &fragments =
+                      std::vector<std::string>()) const;
+
+private:
+  TraceRecorder();
+
+  /// @brief The number of the calling thread, mutex has to be held
+  unsigned getThreadNumber_();
+
+  std::atomic<bool> enabled;   ///< If the spans are recorded
+  mutable std::mutex mutex;    ///< Protects the following members
+  std::string events;          ///< Formatted events, comma separated
+  std::map<std::thread::id, unsigned> threads; ///< Thread numbers
+  std::thread::id mainThread;  ///< Thread that enabled the recorder
+  int processId;               ///< Identifier of this process
+};
+
+/// @brief Record the time of its scope in the registry and a span in the
+///        trace, for the ones enabled
+/// @details When both are disabled nothing is copied nor recorded.
+class ScopedTimer {
+public:
+  ScopedTimer(const std::string &source, const char *phase)
+      : ScopedTimer(source, std::string(), std::string(), phase) {}
+  ScopedTimer(const std::string &source, const std::string &operatorId,
+              const std::string &mutatorId, const char *phase)
+      : stats(StatsRegistry::get().isEnabled()),
+        trace(TraceRecorder::get().isEnabled()),
+        source(stats || trace ? source : std::string()),
+        operatorId(stats || trace ? operatorId : std::string()),
+        mutatorId(stats || trace ? mutatorId : std::string()), phase(phase) {}
+  ~ScopedTimer() {
+    if (!this->stats && !this->trace) {
+      return;
+    }
+    PhaseTime time = this->stopwatch.elapsed();
+    if (this->stats) {
+      StatsRegistry::get().addTime(this->source, this->operatorId,
+                                   this->mutatorId, this->phase, time);
+    }
+    if (this->trace) {
+      std::vector<TraceArg> args;
+      args.push_back(TraceArg("source", this->source));
+      if (!this->operatorId.empty()) {
+        args.push_back(TraceArg("operator", this->operatorId));
+      }
+      if (!this->mutatorId.empty()) {
+        args.push_back(TraceArg("mutator", this->mutatorId));
+      }
+      if (!this->detail.empty()) {
+        args.push_back(TraceArg("detail", this->detail));
+      }
+      TraceRecorder::get().addSpan(this->phase, this->stopwatch.getWallStart(),
+                                   time.wall, args);
+    }
+  }
+
+  /// @brief If the span is traced, so that the details are used
+  bool isTraced() const { return this->trace; }
+  /// @brief Set a detail shown with the span, as the mutated function
+  void setDetail(const std::string &val) {
+    if (this->trace) {
+      this->detail = val;
+    }
+  }
+
+private:
+  bool stats;             ///< If the registry was enabled at the start
+  bool trace;             ///< If the recorder was enabled at the start
+  std::string source;     ///< Source of the phase
+  std::string operatorId; ///< Operator of the phase, if any
+  std::string mutatorId;  ///< Mutator of the phase, if any
+  std::string detail;     ///< Detail of the span, if any
+  const char *phase;      ///< Phase name
+  Stopwatch stopwatch;    ///< Started at the construction
+};
+
+} // End chimera::stats namespace
+} // End chimera namespace
+
+#endif /* INCLUDE_STATS_H_ */
@@ -31,11 +31,13 @@
 
 // Include the header in which mutators are defined
 #include "Operators/Examples/Mutators.h"
+#include "Operators/LoopFirst/Mutators.h"
 
 /// \addtogroup MUTATORS_TESTING Test cases for the Sample Mutators
 /// \{
 // Test mutators
 CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::examples::MutatorGreaterOpReplacement,mutator_greater_op_replacement );
+CHIMERA_MUTATOR_MATCH_TEST ( ::chimera::perforation::MutatorLoopPerforation1,mutator_loop_perforation_operator );
 /// \}
 
 #endif /* INCLUDE_TESTING_MUTATORS_TESTING_H_ */
@@ -0,0 +1,112 @@
+//===- ASTCache.h -----------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ASTCache.h
+/// \author Federico Iannucci
+/// \brief  This file contains the on-disk cache of the serialized ASTs
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TOOLING_ASTCACHE_H_
+#define INCLUDE_TOOLING_ASTCACHE_H_
+
+#include "clang/Tooling/CompilationDatabase.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Forward declarations
+namespace clang {
+class ASTUnit;
+class PCHContainerOperations;
+class SourceManager;
+}
+
+namespace chimera {
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief On-disk cache of the ASTs of the source files, serialized by clang
+/// @details An entry is named after the MD5 of the clang version, of the
+///          compile command, of the source path and of the source content:
+///          - <key>.ast, the serialized AST
+///          - <key>.deps, the MD5 and the absolute path of every file read by
+///            the parse, one per line, and the paths where its include
+///            lookups found no file, with a digest of dashes
+///          An entry is used only if all its files still have the same MD5
+///          and the missed paths are still absent, otherwise the source is
+///          parsed again and the entry replaced. The .deps file is written
+///          last, so an incomplete entry is never used, and touched at each
+///          use, see prune().
+///          The cache can be shared by threads and processes.
+class ASTCache {
+ public:
+  /// @brief Ctor
+  /// @param directory The directory of the entries, created if missing
+  ASTCache(const ::std::string& directory);
+  ~ASTCache();
+
+  /// @brief Get the AST of a source file, from the cache if its entry is
+  ///        valid, otherwise parsing the file and saving the new entry
+  /// @param command The compile command for the source file
+  /// @param sourceFilePath The absolute path to the source file
+  /// @param cached It is set to true if the AST has been loaded from the cache
+  /// @return The AST, nullptr if the source couldn't be read or parsed. The
+  ///         AST of a source with errors is returned but not cached
+  ::std::unique_ptr<::clang::ASTUnit> getAST(
+      const ::clang::tooling::CompileCommand& command,
+      const ::std::string& sourceFilePath, bool& cached);
+
+  /// @brief Remove the entries unused for more than maxAge seconds, then the
+  ///        least recently used ones until the entries take at most maxSize
+  ///        bytes, and the leftovers of failed saves
+  /// @param maxSize Maximum size of the entries in bytes, 0 for no limit
+  /// @param maxAge Maximum age of the entries in seconds, 0 for no limit
+  void prune(uint64_t maxSize, uint64_t maxAge);
+
+  /// @brief The MD5 and the absolute path of the files read by a parse, as
+  ///        they are recorded in the .deps files, sorted by MD5
+  /// @param sourceManager The source manager of the parse
+  /// @param withMainFile If the main file is recorded too
+  /// @param deps The lines "<MD5> <path>" are appended to it
+  /// @return If all the files could be read
+  static bool digestFiles(const ::clang::SourceManager& sourceManager,
+                          bool withMainFile, ::std::string& deps);
+
+  const ::std::string& getDirectory() const {
+    return this->directory;
+  }
+
+ private:
+  /// @brief Load the AST of an entry, if all its files are unchanged
+  ::std::unique_ptr<::clang::ASTUnit> load_(const ::std::string& entryPath);
+  /// @brief Parse a source file as the compile command says
+  ::std::unique_ptr<::clang::ASTUnit> parse_(
+      const ::clang::tooling::CompileCommand& command,
+      const ::std::string& sourceFilePath);
+  /// @brief Save the AST of an entry and the MD5 of the files it read
+  /// @return If the entry has been saved
+  bool save_(::clang::ASTUnit& unit, const ::std::string& entryPath);
+
+  ::std::string directory;  ///< Directory of the entries, with trailing pathSep
+  ::std::shared_ptr<::clang::PCHContainerOperations> pchContainerOps;
+};
+
+}  // end chimera namespace
+#endif /* INCLUDE_TOOLING_ASTCACHE_H_ */
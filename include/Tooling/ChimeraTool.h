@@ -27,9 +27,13 @@
 #define SRC_INCLUDE_CHIMERA_H_
 
 #include "Core/MutationOperator.h"
+#include "Utils.h"
 
 #include "llvm/ADT/StringMap.h"
 
+#include <string>
+#include <vector>
+
 // Forward declarations
 namespace clang { namespace tooling { class CompilationDatabase; } }
 
@@ -82,6 +86,27 @@ public:
     int run ( int argc, const char **argv );
 
 private:
+    /// \brief Mutate a source file
+    /// \param sourcePath The absolute path of the source
+    /// \param compilations The compilation database for the source
+    /// \param confMap The functions/operators filter
+    /// \param outputPath The output directory
+    /// \param validationJobs Number of threads checking the mutants
+    /// \return status
+    int runOnSource_ ( ::std::string sourcePath,
+                       const ::clang::tooling::CompilationDatabase &compilations,
+                       const conf::FunOpConfMap &confMap,
+                       const ::std::string &outputPath,
+                       unsigned validationJobs );
+
+    /// \brief Mutate the source files using up to jobs child processes
+    /// \return status, 0 if all the sources have been mutated
+    int runOnSourcesInParallel_ ( const ::std::vector<::std::string> &sourcePaths,
+                                  const ::clang::tooling::CompilationDatabase &compilations,
+                                  const conf::FunOpConfMap &confMap,
+                                  const ::std::string &outputPath,
+                                  unsigned jobs );
+
     ::clang::tooling::CompilationDatabase *compilationDatabasePtr;
     MutationOperatorPtrMap registeredOperatorMap;
 };
@@ -29,6 +29,7 @@
 #define INCLUDE_FRONTENDACTIONS_H_
 
 #include "clang/AST/ASTConsumer.h"
+#include "clang/AST/Decl.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Tooling/Tooling.h"
@@ -36,8 +37,29 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <functional>
+
 namespace chimera {
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Selects the functions whose bodies are parsed, the bodies of all
+///        the other functions are skipped by the parser
+using FunctionBodyFilter = ::std::function<bool(const clang::FunctionDecl&)>;
+
+/// @brief ASTConsumer that lets the parser skip the bodies of the functions
+///        not selected by a FunctionBodyFilter
+/// @details The constexpr functions and the ones with a deduced return type
+///          are always parsed, as Sema needs their bodies.
+class FunctionBodyFilterConsumer : public clang::ASTConsumer {
+ public:
+  FunctionBodyFilterConsumer(const FunctionBodyFilter& filter)
+      : filter(filter) {
+  }
+  bool shouldSkipFunctionBody(clang::Decl* D) override;
+ private:
+  FunctionBodyFilter filter;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Check the syntax of the source file
 /// @param Output stream
@@ -46,6 +68,62 @@ namespace chimera {
 int checkSyntaxAction(const ::clang::tooling::CompileCommand&,
                       const std::string& sourceFilePath);
 
+/// @brief Check the syntax of an in-memory version of the source file
+/// @details The code is remapped on sourceFilePath, nothing is written on
+///          disk. The working directory of the process isn't changed, so the
+///          in-memory checks can run on several threads.
+/// @param The compile command for the source file
+/// @param sourceFilePath The path to the source file
+/// @param code The source code to check in place of the file content
+int checkSyntaxAction(const ::clang::tooling::CompileCommand&,
+                      const std::string& sourceFilePath,
+                      ::llvm::StringRef code);
+
+/// @brief Check the syntax of an in-memory version of the source file,
+///        parsing only the bodies of the functions selected by filter
+/// @param The compile command for the source file
+/// @param sourceFilePath The path to the source file
+/// @param code The source code to check in place of the file content
+/// @param filter The functions whose bodies are parsed
+int checkSyntaxAction(const ::clang::tooling::CompileCommand&,
+                      const std::string& sourceFilePath,
+                      ::llvm::StringRef code,
+                      const FunctionBodyFilter& filter);
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Syntax check that parses only the bodies of some functions, the
+///        bodies of all the other functions are skipped
+/// @details Declarations at file scope are always parsed, so global symbols
+///          inserted before the function are checked as well.
+class FunctionSyntaxOnlyAction : public clang::SyntaxOnlyAction {
+ public:
+  /// @brief Ctor
+  /// @param functionName The qualified name of the function to check
+  FunctionSyntaxOnlyAction(const ::std::string& functionName);
+  /// @brief Ctor
+  /// @param filter The functions to check
+  FunctionSyntaxOnlyAction(const FunctionBodyFilter& filter)
+      : filter(filter) {
+  }
+  /// @brief Enable the skipping of the function bodies
+  bool BeginInvocation(clang::CompilerInstance& CI) override;
+  /// @brief Create the consumer that selects the bodies to parse
+  ::std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(
+      clang::CompilerInstance&, llvm::StringRef) override;
+ private:
+  FunctionBodyFilter filter;
+};
+/// @brief Check the syntax of an in-memory version of the source file,
+///        parsing only the body of functionName
+/// @param The compile command for the source file
+/// @param sourceFilePath The path to the source file
+/// @param code The source code to check in place of the file content
+/// @param functionName The qualified name of the function to check
+int checkFunctionSyntaxAction(const ::clang::tooling::CompileCommand&,
+                              const std::string& sourceFilePath,
+                              ::llvm::StringRef code,
+                              const std::string& functionName);
+
 /// @brief Put on an raw_ostream the function definitions in the sourceFilePath
 /// @param Output stream
 /// @param The compile command for the source file
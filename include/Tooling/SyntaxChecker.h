@@ -0,0 +1,86 @@
+//===- SyntaxChecker.h ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file SyntaxChecker.h
+/// \author Federico Iannucci
+/// \brief  This file contains the syntax checkers for the mutants
+//===----------------------------------------------------------------------===//
+
+#ifndef INCLUDE_TOOLING_SYNTAXCHECKER_H_
+#define INCLUDE_TOOLING_SYNTAXCHECKER_H_
+
+#include "clang/Tooling/CompilationDatabase.h"
+
+#include "llvm/ADT/StringRef.h"
+
+#include <memory>
+#include <string>
+
+// Forward declarations
+namespace clang {
+class ASTUnit;
+class PCHContainerOperations;
+}
+
+namespace chimera {
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Syntax checker that reuses a precompiled preamble
+/// @details The translation unit is loaded once in an ASTUnit, the preamble
+///          (the leading #include and macro directives of the main file) is
+///          precompiled and every following check reparses only the main file
+///          content, remapped on an in-memory buffer.
+///          The preamble is rebuilt by clang only when the mutated code
+///          changes it.
+class PreambleSyntaxChecker {
+ public:
+  /// @brief Ctor
+  /// @param command The compile command for the source file
+  /// @param sourceFilePath The absolute path to the source file
+  PreambleSyntaxChecker(const ::clang::tooling::CompileCommand& command,
+                        const ::std::string& sourceFilePath);
+  ~PreambleSyntaxChecker();
+
+  /// @brief Check the syntax of the code in place of the source file content
+  /// @param code The source code to check
+  /// @param passed It is set to the result of the check
+  /// @return If the check has been performed, otherwise the translation unit
+  ///         couldn't be loaded and the caller has to use another checker
+  bool check(::llvm::StringRef code, bool& passed);
+
+  /// @brief If the translation unit has been (or could still be) loaded
+  bool isUsable() const {
+    return !this->loadFailed;
+  }
+
+ private:
+  /// @brief Load the translation unit parsing code as main file content
+  /// @return If the translation unit has been loaded
+  bool load_(::llvm::StringRef code);
+
+  ::clang::tooling::CompileCommand command;  ///< Compile command of the TU
+  ::std::string sourceFilePath;  ///< Path of the main file
+  ::std::shared_ptr<::clang::PCHContainerOperations> pchContainerOps;
+  ::std::unique_ptr<::clang::ASTUnit> unit;  ///< Unit holding the preamble
+  bool loadFailed;  ///< If the loading of the unit failed
+};
+
+}  // end chimera namespace
+#endif /* INCLUDE_TOOLING_SYNTAXCHECKER_H_ */
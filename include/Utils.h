@@ -47,6 +47,10 @@ namespace conf {
 /// only the operators
 /// that will be applied to all functions found.
 ///
+/// A function can be given by name, qualified or not, as "a::f", or by
+/// pattern: a glob with * and ?, as "dsp::*_kernel", or an extended regular
+/// expression on the qualified name prefixed by "re:", as "re:dsp::.*_kernel".
+///
 /// To comment a configuration entry use -> //.
 using FunOpConfMap = std::map<std::string, std::vector<std::string>>;
 
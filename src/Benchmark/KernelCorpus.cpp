@@ -0,0 +1,179 @@
+//===- KernelCorpus.cpp -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file KernelCorpus.cpp
+/// \author Federico Iannucci
+/// \brief This file implements the corpus of kernels of the benchmarks
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark/KernelCorpus.h"
+#include "Utils.h"
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace chimera::bench;
+
+std::vector<Kernel> chimera::bench::findKernels(
+    const std::string &corpusDirectory) {
+  std::vector<Kernel> kernels;
+  std::error_code error;
+  for (llvm::sys::fs::directory_iterator entry(corpusDirectory, error), end;
+       entry != end && !error; entry.increment(error)) {
+    Kernel kernel;
+    kernel.name = llvm::sys::path::filename(entry->path()).str();
+    kernel.directory = entry->path() + chimera::fs::pathSep;
+    if (llvm::sys::fs::exists(kernel.getKernelPath()) &&
+        llvm::sys::fs::exists(kernel.getDriverPath()) &&
+        llvm::sys::fs::exists(kernel.getConfPath()) &&
+        llvm::sys::fs::exists(kernel.getGoldenPath())) {
+      kernels.push_back(kernel);
+    }
+  }
+  std::sort(kernels.begin(), kernels.end(),
+            [](const Kernel &a, const Kernel &b) { return a.name < b.name; });
+  return kernels;
+}
+
+/// @brief Split a text on white spaces
+static std::vector<llvm::StringRef> tokenize(llvm::StringRef text) {
+  std::vector<llvm::StringRef> tokens;
+  const char *spaces = " \t\r\n";
+  for (text = text.ltrim(spaces); !text.empty();) {
+    size_t end = text.find_first_of(spaces);
+    tokens.push_back(text.substr(0, end));
+    text = text.substr(end).ltrim(spaces);
+  }
+  return tokens;
+}
+
+/// @brief Parse a whole token as a number
+static bool parseNumber(llvm::StringRef token, double &value) {
+  std::string text = token.str();
+  char *end;
+  value = std::strtod(text.c_str(), &end);
+  return !text.empty() && *end == '\0';
+}
+
+OutputError chimera::bench::compareOutput(llvm::StringRef output,
+                                          llvm::StringRef golden) {
+  OutputError result;
+  std::vector<llvm::StringRef> outputTokens = tokenize(output);
+  std::vector<llvm::StringRef> goldenTokens = tokenize(golden);
+  if (outputTokens.size() != goldenTokens.size()) {
+    return result;
+  }
+  result.identical = true;
+  double errorSum = 0;
+  double goldenMax = 0;
+  unsigned numbers = 0;
+  for (size_t i = 0; i < goldenTokens.size(); ++i) {
+    if (outputTokens[i] == goldenTokens[i]) {
+      double value;
+      if (parseNumber(goldenTokens[i], value)) {
+        goldenMax = std::max(goldenMax, std::fabs(value));
+        ++numbers;
+      }
+      continue;
+    }
+    result.identical = false;
+    double outputValue, goldenValue;
+    if (!parseNumber(outputTokens[i], outputValue) ||
+        !parseNumber(goldenTokens[i], goldenValue)) {
+      return result;
+    }
+    goldenMax = std::max(goldenMax, std::fabs(goldenValue));
+    errorSum += std::fabs(outputValue - goldenValue);
+    ++numbers;
+  }
+  result.comparable = true;
+  if (numbers > 0 && goldenMax > 0) {
+    result.error = errorSum / numbers / goldenMax;
+  } else if (!result.identical) {
+    result.error = errorSum > 0 ? 1 : 0;
+  }
+  return result;
+}
+
+chimera::bench::KernelRunner::KernelRunner(
+    const std::string &compiler, const std::vector<std::string> &flags,
+    unsigned timeout)
+    : flags(flags), timeout(timeout) {
+  if (llvm::sys::path::is_absolute(compiler)) {
+    this->compilerPath = compiler;
+  } else {
+    auto path = llvm::sys::findProgramByName(compiler);
+    if (path) {
+      this->compilerPath = *path;
+    }
+  }
+}
+
+bool chimera::bench::KernelRunner::buildAndRun(
+    const Kernel &kernel, const std::string &sourcePath,
+    const std::string &workDirectory, std::string &output) const {
+  output.clear();
+  std::string executablePath = workDirectory + "kernel.bin";
+  std::string logPath = workDirectory + "build.log";
+  std::string outputPath = workDirectory + "output.txt";
+  std::string driverPath = kernel.getDriverPath();
+  std::string includeFlag = "-I" + kernel.directory;
+
+  // Build, the kernel directory is searched for the headers of the kernel
+  std::vector<const char *> args;
+  args.push_back(this->compilerPath.c_str());
+  for (const std::string &flag : this->flags) {
+    args.push_back(flag.c_str());
+  }
+  args.push_back(includeFlag.c_str());
+  args.push_back(sourcePath.c_str());
+  args.push_back(driverPath.c_str());
+  args.push_back("-o");
+  args.push_back(executablePath.c_str());
+  args.push_back(nullptr);
+  llvm::StringRef noInput("");
+  llvm::StringRef log(logPath);
+  const llvm::StringRef *buildRedirects[] = {&noInput, &log, &log};
+  if (llvm::sys::ExecuteAndWait(this->compilerPath, args.data(), nullptr,
+                                buildRedirects) != 0) {
+    return false;
+  }
+
+  // Run
+  const char *runArgs[] = {executablePath.c_str(), nullptr};
+  llvm::StringRef outputFile(outputPath);
+  const llvm::StringRef *runRedirects[] = {&noInput, &outputFile, &noInput};
+  if (llvm::sys::ExecuteAndWait(executablePath, runArgs, nullptr,
+                                runRedirects, this->timeout) != 0) {
+    return false;
+  }
+  auto buffer = llvm::MemoryBuffer::getFile(outputPath);
+  if (!buffer) {
+    return false;
+  }
+  output = (*buffer)->getBuffer();
+  return true;
+}
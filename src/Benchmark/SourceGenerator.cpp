@@ -0,0 +1,108 @@
+//===- SourceGenerator.cpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file SourceGenerator.cpp
+/// \author Federico Iannucci
+/// \brief This file implements the generator of the synthetic translation
+///        units of the benchmarks
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark/SourceGenerator.h"
+
+using namespace chimera::bench;
+
+/// @brief Float expressions, cycled, on the variables r, a, b and c
+static const char *floatExpressions[] = {
+    "r = r * b + c;",         "r = (r - a) / (b + 1.5f);",
+    "r = a * a - b * c + r;", "r = r + a / (c + 2.0f);",
+    "r = (a + b) * (r - c);", "r = r * 0.5f - a * b;"};
+
+/// @brief Generate a function of float expressions
+static void generateFloatFunction(const SourceShape &shape, unsigned group,
+                                  std::string &source) {
+  const unsigned expressions =
+      sizeof(floatExpressions) / sizeof(floatExpressions[0]);
+  source += "float bench_float_" + std::to_string(group) +
+            "(float a, float b, float c) {\n  float r = a;\n";
+  for (unsigned i = 0; i < shape.floatExpressions; ++i) {
+    source += "  ";
+    source += floatExpressions[(group + i) % expressions];
+    source += "\n";
+  }
+  source += "  return r;\n}\n\n";
+}
+
+/// @brief Generate a function of loop nests over an array
+static void generateLoopFunction(const SourceShape &shape, unsigned group,
+                                 std::string &source) {
+  source += "int bench_loops_" + std::to_string(group) +
+            "(int n, const int *data) {\n  int acc = 0;\n";
+  for (unsigned loop = 0; loop < shape.loops; ++loop) {
+    std::string indent = "  ";
+    for (unsigned depth = 0; depth < shape.loopDepth; ++depth) {
+      std::string index = "i" + std::to_string(depth);
+      source += indent + "for (int " + index + " = 0; " + index + " < n; " +
+                index + "++) {\n";
+      indent += "  ";
+    }
+    source += indent + "acc = acc + data[i" +
+              std::to_string(shape.loopDepth - 1) + "] * " +
+              std::to_string(loop + 1) + ";\n";
+    for (unsigned depth = 0; depth < shape.loopDepth; ++depth) {
+      indent.resize(indent.size() - 2);
+      source += indent + "}\n";
+    }
+  }
+  source += "  return acc;\n}\n\n";
+}
+
+/// @brief Generate a function of integer add chains
+static void generateAddFunction(const SourceShape &shape, unsigned group,
+                                std::string &source) {
+  const char *operands[] = {"a", "b", "c", "d"};
+  source += "int bench_adds_" + std::to_string(group) +
+            "(int a, int b, int c, int d) {\n  int s = 0;\n";
+  for (unsigned chain = 0; chain < shape.addChains; ++chain) {
+    source += "  s = s";
+    for (unsigned i = 0; i < shape.addChainLength; ++i) {
+      source += (i + chain) % 3 == 2 ? " - " : " + ";
+      source += operands[(i + chain) % 4];
+    }
+    source += ";\n";
+  }
+  source += "  return s;\n}\n\n";
+}
+
+std::string chimera::bench::generateSource(const SourceShape &shape) {
+  std::string source = "// Synthetic translation unit generated by "
+                       "chimera-bench\n\n";
+  for (unsigned group = 0; group < shape.groups; ++group) {
+    if (shape.floatExpressions > 0) {
+      generateFloatFunction(shape, group, source);
+    }
+    if (shape.loops > 0 && shape.loopDepth > 0) {
+      generateLoopFunction(shape, group, source);
+    }
+    if (shape.addChains > 0 && shape.addChainLength > 0) {
+      generateAddFunction(shape, group, source);
+    }
+  }
+  return source;
+}
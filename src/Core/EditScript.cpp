@@ -0,0 +1,282 @@
+//===- EditScript.cpp -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file EditScript.cpp
+/// \author Federico Iannucci
+/// \brief This file contains the implementation of the class EditScript
+//===----------------------------------------------------------------------===//
+
+#include "Core/EditScript.h"
+
+#include "llvm/ADT/StringMap.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+using namespace chimera::mutant;
+
+/// @brief Maximum number of inserted and deleted lines the diff looks for,
+///        above it the changed region is a single edit
+static const int maxDiffDistance = 1024;
+
+/// @brief Split a text in lines, each one with its newline
+static void splitLines(::llvm::StringRef text,
+                       ::std::vector<::llvm::StringRef> &lines) {
+  while (!text.empty()) {
+    size_t end = text.find('\n');
+    end = end == ::llvm::StringRef::npos ? text.size() : end + 1;
+    lines.push_back(text.substr(0, end));
+    text = text.substr(end);
+  }
+}
+
+/// @brief Add the edit turning original[originalBegin, originalEnd) in
+///        mutated[mutatedBegin, mutatedEnd), without their common ends
+static void addHunk(EditScript &script, ::llvm::StringRef original,
+                    size_t originalBegin, size_t originalEnd,
+                    ::llvm::StringRef mutated, size_t mutatedBegin,
+                    size_t mutatedEnd) {
+  while (originalBegin < originalEnd && mutatedBegin < mutatedEnd &&
+         original[originalBegin] == mutated[mutatedBegin]) {
+    ++originalBegin;
+    ++mutatedBegin;
+  }
+  while (originalBegin < originalEnd && mutatedBegin < mutatedEnd &&
+         original[originalEnd - 1] == mutated[mutatedEnd - 1]) {
+    --originalEnd;
+    --mutatedEnd;
+  }
+  if (originalBegin < originalEnd || mutatedBegin < mutatedEnd) {
+    script.addEdit(originalBegin, originalEnd - originalBegin,
+                   mutated.slice(mutatedBegin, mutatedEnd));
+  }
+}
+
+/// @brief The matching lines of two sequences, by the Myers O(ND) diff
+/// @param a The lines of the first sequence, as numbers
+/// @param b The lines of the second sequence, as numbers
+/// @param matches It is set to the pairs of matching lines, in order
+/// @return If the sequences differ by at most maxDiffDistance lines
+static bool matchLines(const ::std::vector<unsigned> &a,
+                       const ::std::vector<unsigned> &b,
+                       ::std::vector<::std::pair<int, int>> &matches) {
+  const int n = a.size();
+  const int m = b.size();
+  const int maxDistance = ::std::min(n + m, maxDiffDistance);
+  // v[k + offset] is the furthest x on the diagonal k = x - y, the trace
+  // keeps the diagonals -(d + 1)..(d + 1) before each step d
+  const int offset = maxDistance + 1;
+  ::std::vector<int> v(2 * offset + 1, 0);
+  ::std::vector<::std::vector<int>> trace;
+  int distance = -1;
+  for (int d = 0; d <= maxDistance && distance < 0; ++d) {
+    trace.emplace_back(v.begin() + offset - d - 1, v.begin() + offset + d + 2);
+    for (int k = -d; k <= d; k += 2) {
+      int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                  ? v[offset + k + 1]
+                  : v[offset + k - 1] + 1;
+      int y = x - k;
+      while (x < n && y < m && a[x] == b[y]) {
+        ++x;
+        ++y;
+      }
+      v[offset + k] = x;
+      if (x >= n && y >= m) {
+        distance = d;
+        break;
+      }
+    }
+  }
+  if (distance < 0) {
+    return false;
+  }
+
+  // Walk the trace back from the end
+  int x = n, y = m;
+  for (int d = distance; d >= 0; --d) {
+    const ::std::vector<int> &previous = trace[d];
+    auto at = [&previous, d](int k) { return previous[k + d + 1]; };
+    int k = x - y;
+    int previousK =
+        (k == -d || (k != d && at(k - 1) < at(k + 1))) ? k + 1 : k - 1;
+    int previousX = d == 0 ? 0 : at(previousK);
+    int previousY = d == 0 ? 0 : previousX - previousK;
+    while (x > previousX && y > previousY) {
+      --x;
+      --y;
+      matches.emplace_back(x, y);
+    }
+    x = previousX;
+    y = previousY;
+  }
+  ::std::reverse(matches.begin(), matches.end());
+  return true;
+}
+
+EditScript chimera::mutant::EditScript::diff(::llvm::StringRef original,
+                                             ::llvm::StringRef mutated) {
+  EditScript script;
+  size_t prefix = 0;
+  size_t maxPrefix = ::std::min(original.size(), mutated.size());
+  while (prefix < maxPrefix && original[prefix] == mutated[prefix]) {
+    ++prefix;
+  }
+  size_t suffix = 0;
+  size_t maxSuffix = maxPrefix - prefix;
+  while (suffix < maxSuffix && original[original.size() - 1 - suffix] ==
+                                   mutated[mutated.size() - 1 - suffix]) {
+    ++suffix;
+  }
+  if (prefix + suffix == original.size() && prefix + suffix == mutated.size()) {
+    return script;
+  }
+
+  // The changed region, widened to whole lines inside the common ends
+  size_t begin = original.substr(0, prefix).rfind('\n');
+  begin = begin == ::llvm::StringRef::npos ? 0 : begin + 1;
+  size_t originalEnd = original.find('\n', original.size() - suffix);
+  originalEnd =
+      originalEnd == ::llvm::StringRef::npos ? original.size() : originalEnd + 1;
+  size_t mutatedEnd = mutated.size() - (original.size() - originalEnd);
+
+  ::std::vector<::llvm::StringRef> originalLines, mutatedLines;
+  splitLines(original.slice(begin, originalEnd), originalLines);
+  splitLines(mutated.slice(begin, mutatedEnd), mutatedLines);
+  ::llvm::StringMap<unsigned> lineNumbers;
+  ::std::vector<unsigned> a, b;
+  for (::llvm::StringRef line : originalLines) {
+    a.push_back(lineNumbers.insert({line, lineNumbers.size()}).first->second);
+  }
+  for (::llvm::StringRef line : mutatedLines) {
+    b.push_back(lineNumbers.insert({line, lineNumbers.size()}).first->second);
+  }
+  ::std::vector<::std::pair<int, int>> matches;
+  if (!matchLines(a, b, matches)) {
+    addHunk(script, original, begin, originalEnd, mutated, begin, mutatedEnd);
+    return script;
+  }
+
+  // An edit between each pair of consecutive matching lines
+  matches.emplace_back(a.size(), b.size());
+  size_t originalOffset = begin, mutatedOffset = begin;
+  size_t nextA = 0, nextB = 0;
+  for (const auto &match : matches) {
+    size_t hunkOriginalEnd = originalOffset;
+    for (; nextA < static_cast<size_t>(match.first); ++nextA) {
+      hunkOriginalEnd += originalLines[nextA].size();
+    }
+    size_t hunkMutatedEnd = mutatedOffset;
+    for (; nextB < static_cast<size_t>(match.second); ++nextB) {
+      hunkMutatedEnd += mutatedLines[nextB].size();
+    }
+    addHunk(script, original, originalOffset, hunkOriginalEnd, mutated,
+            mutatedOffset, hunkMutatedEnd);
+    originalOffset = hunkOriginalEnd;
+    mutatedOffset = hunkMutatedEnd;
+    if (nextA < a.size()) {
+      // Skip the matching line
+      originalOffset += originalLines[nextA++].size();
+      mutatedOffset += mutatedLines[nextB++].size();
+    }
+  }
+  return script;
+}
+
+bool chimera::mutant::EditScript::addEdit(size_t offset, size_t length,
+                                          ::llvm::StringRef replacement) {
+  if (length > SIZE_MAX - offset ||
+      (!this->edits.empty() &&
+       offset < this->edits.back().offset + this->edits.back().length)) {
+    return false;
+  }
+  this->edits.push_back(Edit{offset, length, replacement.str()});
+  return true;
+}
+
+bool chimera::mutant::EditScript::apply(::llvm::StringRef original,
+                                        ::std::string &mutated) const {
+  // The edits are sorted and don't overlap, the last one has to end inside
+  // the original source
+  if (!this->edits.empty() &&
+      this->edits.back().offset + this->edits.back().length >
+          original.size()) {
+    return false;
+  }
+  size_t growth = 0;
+  for (const Edit &edit : this->edits) {
+    growth += edit.replacement.size();
+  }
+  mutated.clear();
+  mutated.reserve(original.size() + growth);
+  size_t copied = 0; // Original bytes already copied
+  for (const Edit &edit : this->edits) {
+    mutated.append(original.data() + copied, edit.offset - copied);
+    mutated += edit.replacement;
+    copied = edit.offset + edit.length;
+  }
+  mutated.append(original.data() + copied, original.size() - copied);
+  return true;
+}
+
+void chimera::mutant::EditScript::write(::llvm::raw_ostream &out) const {
+  for (const Edit &edit : this->edits) {
+    out << edit.offset << " " << edit.length << " " << edit.replacement.size()
+        << "\n" << edit.replacement << "\n";
+  }
+}
+
+::std::string chimera::mutant::EditScript::str() const {
+  ::std::string serialized;
+  ::llvm::raw_string_ostream out(serialized);
+  this->write(out);
+  return out.str();
+}
+
+bool chimera::mutant::EditScript::read(::llvm::StringRef data,
+                                       EditScript &script) {
+  script.edits.clear();
+  while (!data.empty()) {
+    // Header: offset, length and replacement size
+    size_t newline = data.find('\n');
+    if (newline == ::llvm::StringRef::npos) {
+      return false;
+    }
+    ::llvm::StringRef header = data.substr(0, newline);
+    data = data.substr(newline + 1);
+    ::std::pair<::llvm::StringRef, ::llvm::StringRef> field = header.split(' ');
+    size_t offset, length, size;
+    if (field.first.getAsInteger(10, offset)) {
+      return false;
+    }
+    field = field.second.split(' ');
+    if (field.first.getAsInteger(10, length) ||
+        field.second.getAsInteger(10, size)) {
+      return false;
+    }
+    // Replacement, followed by a newline
+    if (data.size() < size + 1 || data[size] != '\n' ||
+        !script.addEdit(offset, length, data.substr(0, size))) {
+      return false;
+    }
+    data = data.substr(size + 1);
+  }
+  return true;
+}
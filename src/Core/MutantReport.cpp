@@ -0,0 +1,240 @@
+//===- MutantReport.cpp -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantReport.cpp
+/// \author Federico Iannucci
+/// \brief This file implements the sinks of the mutants report
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutantReport.h"
+#include "Log.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+using namespace chimera::mutant;
+using namespace chimera::log;
+
+/// @brief Bytes written atomically on a pipe
+#ifdef PIPE_BUF
+static const size_t pipeAtomicSize = PIPE_BUF;
+#else
+static const size_t pipeAtomicSize = 512; // The POSIX minimum
+#endif
+
+namespace {
+/// @brief report.csv, as it has always been, or aliases.csv: the same
+///        columns, for the alias entries only
+class CsvSink : public ReportSink {
+ public:
+  CsvSink(const ::std::string &path, bool atomic, bool aliases)
+      : ReportSink(path, atomic), aliases(aliases) {}
+
+ protected:
+  virtual void format_(const ReportEntry &entry, ::llvm::raw_ostream &out) {
+    if ((entry.aliasOf != 0) != this->aliases) {
+      return;
+    }
+    out << entry.id << "," << entry.function << "," << entry.line << ","
+        << entry.column << "," << entry.mutator << "," << entry.type << "\n";
+  }
+
+ private:
+  bool aliases; ///< If only the alias entries are written
+};
+
+/// @brief A JSON object per line
+class NdjsonSink : public ReportSink {
+ public:
+  NdjsonSink(const ::std::string &path, bool atomic)
+      : ReportSink(path, atomic) {}
+
+ protected:
+  virtual void format_(const ReportEntry &entry, ::llvm::raw_ostream &out) {
+    out << "{\"id\":" << entry.id << ",\"function\":";
+    writeString(entry.function, out);
+    out << ",\"line\":" << entry.line << ",\"column\":" << entry.column
+        << ",\"mutator\":";
+    writeString(entry.mutator, out);
+    out << ",\"type\":" << entry.type << ",\"alias_of\":" << entry.aliasOf
+        << "}\n";
+  }
+
+ private:
+  /// @brief Write a JSON string
+  static void writeString(::llvm::StringRef value, ::llvm::raw_ostream &out) {
+    out << '"';
+    for (char c : value) {
+      if (c == '"' || c == '\\') {
+        out << '\\' << c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        out << "\\u00";
+        out.write_hex(static_cast<unsigned char>(c) >> 4);
+        out.write_hex(c & 0xf);
+      } else {
+        out << c;
+      }
+    }
+    out << '"';
+  }
+};
+
+/// @brief Fixed width fields followed by the strings
+class BinarySink : public ReportSink {
+ public:
+  BinarySink(const ::std::string &path, bool atomic)
+      : ReportSink(path, atomic) {}
+
+ protected:
+  virtual void header_(::llvm::raw_ostream &out) {
+    out.write(reportBinaryMagic, sizeof(reportBinaryMagic));
+  }
+
+  virtual void format_(const ReportEntry &entry, ::llvm::raw_ostream &out) {
+    uint32_t fields[5] = {entry.id, entry.line, entry.column, entry.type,
+                          entry.aliasOf};
+    uint16_t sizes[2] = {
+        static_cast<uint16_t>(::std::min<size_t>(entry.function.size(),
+                                                 UINT16_MAX)),
+        static_cast<uint16_t>(::std::min<size_t>(entry.mutator.size(),
+                                                 UINT16_MAX))};
+    out.write(reinterpret_cast<const char *>(fields), sizeof(fields));
+    out.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+    out.write(entry.function.data(), sizes[0]);
+    out.write(entry.mutator.data(), sizes[1]);
+  }
+};
+
+/// @brief Create the sink of a format
+::std::unique_ptr<ReportSink> createSink(ReportFormat format,
+                                         const ::std::string &path,
+                                         bool atomic) {
+  switch (format) {
+  case CsvReport:
+    return ::std::unique_ptr<ReportSink>(new CsvSink(path, atomic, false));
+  case NdjsonReport:
+    return ::std::unique_ptr<ReportSink>(new NdjsonSink(path, atomic));
+  case BinaryReport:
+    return ::std::unique_ptr<ReportSink>(new BinarySink(path, atomic));
+  }
+  return nullptr;
+}
+} // End anonymous namespace
+
+bool chimera::mutant::ReportSink::open() {
+  // A report file is written aside, the stream is appended to
+  ::std::string target = this->atomic ? this->path + ".tmp" : this->path;
+  ::std::error_code fileError;
+  this->file.reset(new ::llvm::raw_fd_ostream(
+      target, fileError,
+      this->atomic ? ::llvm::sys::fs::F_None : ::llvm::sys::fs::F_Append));
+  if (fileError) {
+    ChimeraLogger::error("Couldn't open the report " + target + ": " +
+                         fileError.message());
+    this->file.reset();
+    return false;
+  }
+  // Each block is written by a single write
+  this->file->SetUnbuffered();
+  return true;
+}
+
+bool chimera::mutant::ReportSink::close() {
+  this->buffer.flush();
+  if (!this->file && !this->open()) {
+    return false;
+  }
+  ::std::string block;
+  ::llvm::raw_string_ostream blockStream(block);
+  this->header_(blockStream);
+  blockStream.flush();
+  block += this->data;
+  this->data.clear();
+  if (this->atomic) {
+    // A single write of all the entries
+    *this->file << block;
+  } else {
+    // Blocks of whole entries, a write up to PIPE_BUF bytes on a pipe isn't
+    // interleaved with the writes of other processes. A longer entry is
+    // written alone.
+    ::llvm::StringRef entries(block);
+    while (!entries.empty()) {
+      size_t size = entries.size();
+      if (size > pipeAtomicSize) {
+        size = entries.rfind('\n', pipeAtomicSize);
+        size = size == ::llvm::StringRef::npos ? entries.find('\n') : size;
+        size = size == ::llvm::StringRef::npos ? entries.size() : size + 1;
+      }
+      *this->file << entries.substr(0, size);
+      entries = entries.substr(size);
+    }
+  }
+  this->file->close();
+  bool failed = this->file->has_error();
+  this->file->clear_error();
+  this->file.reset();
+  if (failed) {
+    ChimeraLogger::error("An error occurred writing the report " + this->path);
+    return false;
+  }
+  if (this->atomic) {
+    ::std::error_code renameError =
+        ::llvm::sys::fs::rename(this->path + ".tmp", this->path);
+    if (renameError) {
+      ChimeraLogger::error("Couldn't rename the report " + this->path + ": " +
+                           renameError.message());
+      return false;
+    }
+  }
+  return true;
+}
+
+::std::unique_ptr<ReportSink>
+chimera::mutant::ReportSink::createFile(ReportFormat format,
+                                        const ::std::string &path) {
+  return createSink(format, path, true);
+}
+
+::std::unique_ptr<ReportSink>
+chimera::mutant::ReportSink::createAliasFile(const ::std::string &path) {
+  return ::std::unique_ptr<ReportSink>(new CsvSink(path, true, true));
+}
+
+::std::unique_ptr<ReportSink>
+chimera::mutant::ReportSink::createStream(ReportFormat format,
+                                          const ::std::string &path) {
+  return createSink(format, path, false);
+}
+
+const char *chimera::mutant::ReportSink::getFileName(ReportFormat format) {
+  switch (format) {
+  case CsvReport:
+    return "report.csv";
+  case NdjsonReport:
+    return "report.ndjson";
+  case BinaryReport:
+    return "report.bin";
+  }
+  return "report";
+}
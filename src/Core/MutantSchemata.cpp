@@ -0,0 +1,251 @@
+//===- MutantSchemata.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantSchemata.cpp
+/// \author Federico Iannucci
+/// \brief This file contains the implementation of the class MutantSchemata
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutantSchemata.h"
+
+#include <algorithm>
+
+using namespace chimera::mutant;
+
+/// @brief Split code in lines, each one keeps its newline
+static ::std::vector<::std::string> splitLines(::llvm::StringRef code) {
+  ::std::vector<::std::string> lines;
+  while (!code.empty()) {
+    size_t newline = code.find('\n');
+    size_t length = newline == ::llvm::StringRef::npos ? code.size()
+                                                       : newline + 1;
+    lines.push_back(code.substr(0, length).str());
+    code = code.substr(length);
+  }
+  return lines;
+}
+
+/// @brief The kinds of preprocessor conditional directives
+enum ConditionalKind { NotConditional, OpenConditional, ElseConditional,
+                       CloseConditional };
+
+/// @brief The conditional directive on a line, if any
+static ConditionalKind getConditionalKind(::llvm::StringRef line) {
+  line = line.ltrim();
+  if (!line.startswith("#")) {
+    return NotConditional;
+  }
+  ::llvm::StringRef directive = line.drop_front().ltrim();
+  directive = directive.substr(0, directive.find_first_not_of(
+                                      "abcdefghijklmnopqrstuvwxyz"));
+  if (directive == "if" || directive == "ifdef" || directive == "ifndef") {
+    return OpenConditional;
+  }
+  if (directive == "elif" || directive == "else") {
+    return ElseConditional;
+  }
+  if (directive == "endif") {
+    return CloseConditional;
+  }
+  return NotConditional;
+}
+
+/// @brief If the conditional directives of lines are balanced
+static bool isBalanced(const ::std::vector<::std::string> &lines) {
+  size_t depth = 0;
+  for (const auto &line : lines) {
+    switch (getConditionalKind(line)) {
+    case OpenConditional:
+      ++depth;
+      break;
+    case ElseConditional:
+      if (depth == 0) {
+        return false;
+      }
+      break;
+    case CloseConditional:
+      if (depth == 0) {
+        return false;
+      }
+      --depth;
+      break;
+    case NotConditional:
+      break;
+    }
+  }
+  return depth == 0;
+}
+
+chimera::mutant::MutantSchemata::MutantSchemata(::llvm::StringRef original)
+    : original(splitLines(original)) {
+  const size_t npos = ::std::string::npos;
+  this->conditionals.assign(this->original.size(),
+                            ::std::make_pair(npos, npos));
+  // Lines of the directives of each open conditional
+  ::std::vector<::std::vector<size_t>> open;
+  for (size_t i = 0; i < this->original.size(); ++i) {
+    ConditionalKind kind = getConditionalKind(this->original[i]);
+    if (kind == OpenConditional) {
+      open.push_back(::std::vector<size_t>(1, i));
+    } else if (kind != NotConditional && !open.empty()) {
+      open.back().push_back(i);
+      if (kind == CloseConditional) {
+        for (size_t line : open.back()) {
+          this->conditionals[line] = ::std::make_pair(open.back().front(), i);
+        }
+        open.pop_back();
+      }
+    } else if (kind != NotConditional) {
+      // Unbalanced original, a hunk touching it spans the whole file
+      this->conditionals[i] = ::std::make_pair(0, this->original.size() - 1);
+    }
+  }
+  for (const auto &directives : open) {
+    for (size_t line : directives) {
+      this->conditionals[line] = ::std::make_pair(0, this->original.size() - 1);
+    }
+  }
+}
+
+bool chimera::mutant::MutantSchemata::addMutant(IdType id,
+                                                ::llvm::StringRef code) {
+  ::std::vector<::std::string> lines = splitLines(code);
+  // Common leading and trailing lines
+  size_t prefix = 0;
+  while (prefix < this->original.size() && prefix < lines.size() &&
+         this->original[prefix] == lines[prefix]) {
+    ++prefix;
+  }
+  size_t suffix = 0;
+  while (suffix < this->original.size() - prefix &&
+         suffix < lines.size() - prefix &&
+         this->original[this->original.size() - 1 - suffix] ==
+             lines[lines.size() - 1 - suffix]) {
+    ++suffix;
+  }
+
+  // Widen the range to the whole conditionals it touches, the #if/#elif
+  // chain of the schemata can't split them
+  size_t begin = prefix;
+  size_t end = this->original.size() - suffix;
+  bool widened = true;
+  while (widened) {
+    widened = false;
+    for (size_t i = begin; i < end; ++i) {
+      const auto &conditional = this->conditionals[i];
+      if (conditional.first == ::std::string::npos) {
+        continue;
+      }
+      if (conditional.first < begin) {
+        begin = conditional.first;
+        widened = true;
+      }
+      if (conditional.second >= end) {
+        end = conditional.second + 1;
+        widened = true;
+      }
+    }
+  }
+  prefix = begin;
+  suffix = this->original.size() - end;
+
+  Hunk hunk;
+  hunk.begin = begin;
+  hunk.end = end;
+  hunk.lines.assign(lines.begin() + prefix, lines.end() - suffix);
+  if (!isBalanced(hunk.lines)) {
+    // The mutant changes the conditionals themselves
+    this->hunks.erase(id);
+    return false;
+  }
+  this->hunks[id] = ::std::move(hunk);
+  return true;
+}
+
+void chimera::mutant::MutantSchemata::write(::llvm::raw_ostream &out) const {
+  // The changed hunks ordered by position
+  ::std::vector<::std::pair<IdType, const Hunk *>> sorted;
+  for (const auto &hunk : this->hunks) {
+    if (hunk.second.begin != hunk.second.end || !hunk.second.lines.empty()) {
+      sorted.push_back(::std::make_pair(hunk.first, &hunk.second));
+    }
+  }
+  ::std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const ::std::pair<IdType, const Hunk *> &a,
+                        const ::std::pair<IdType, const Hunk *> &b) {
+                       return a.second->begin < b.second->begin;
+                     });
+
+  // Write lines, the last one terminated by a newline if missing
+  auto writeLines = [&out](::std::vector<::std::string>::const_iterator begin,
+                           ::std::vector<::std::string>::const_iterator end,
+                           bool terminate) {
+    ::llvm::StringRef last;
+    for (auto line = begin; line != end; ++line) {
+      out << *line;
+      last = *line;
+    }
+    if (terminate && !last.empty() && !last.endswith("\n")) {
+      out << "\n";
+    }
+  };
+
+  size_t written = 0; // Original lines already written
+  auto hunk = sorted.begin();
+  while (hunk != sorted.end()) {
+    // Group the hunks overlapping or touching each other
+    size_t begin = hunk->second->begin;
+    size_t end = hunk->second->end;
+    auto groupEnd = hunk;
+    while (groupEnd != sorted.end() && groupEnd->second->begin <= end) {
+      end = ::std::max(end, groupEnd->second->end);
+      ++groupEnd;
+    }
+    ::std::vector<::std::pair<IdType, const Hunk *>> group(hunk, groupEnd);
+    ::std::sort(group.begin(), group.end());
+
+    writeLines(this->original.begin() + written,
+               this->original.begin() + begin, true);
+    bool first = true;
+    for (const auto &mutant : group) {
+      out << (first ? "#if " : "#elif ") << schemataMacro
+          << " == " << mutant.first << "\n";
+      first = false;
+      // The mutant version of the group lines
+      ::std::vector<::std::string> lines(
+          this->original.begin() + begin,
+          this->original.begin() + mutant.second->begin);
+      lines.insert(lines.end(), mutant.second->lines.begin(),
+                   mutant.second->lines.end());
+      lines.insert(lines.end(), this->original.begin() + mutant.second->end,
+                   this->original.begin() + end);
+      writeLines(lines.begin(), lines.end(), true);
+    }
+    if (begin != end) {
+      out << "#else\n";
+      writeLines(this->original.begin() + begin, this->original.begin() + end,
+                 true);
+    }
+    out << "#endif\n";
+    written = end;
+    hunk = groupEnd;
+  }
+  writeLines(this->original.begin() + written, this->original.end(), false);
+}
@@ -0,0 +1,367 @@
+//===- MutantStore.cpp ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file MutantStore.cpp
+/// \author Federico Iannucci
+/// \brief This file implements the storages of the generated mutants
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutantStore.h"
+#include "Log.h"
+#include "Utils.h"
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
+using namespace chimera::mutant;
+using namespace chimera::log;
+
+/// @brief Write content in a file, replacing it
+static bool writeFile(const ::std::string &filePath,
+                      ::llvm::StringRef content) {
+  ::std::error_code fileError;
+  ::llvm::raw_fd_ostream file(filePath, fileError, ::llvm::sys::fs::F_Text);
+  if (fileError) {
+    ChimeraLogger::error("An error occurred during the file opening: " +
+                         fileError.message());
+    return false;
+  }
+  file << content;
+  return true;
+}
+
+/// @brief Read the content of a file
+static bool readFile(const ::std::string &filePath, ::std::string &content) {
+  auto buffer = ::llvm::MemoryBuffer::getFile(filePath);
+  if (!buffer) {
+    return false;
+  }
+  content = (*buffer)->getBuffer();
+  return true;
+}
+
+namespace {
+/// @brief Each mutant as a full copy of the source
+class FullSourceStore : public MutantStore {
+ public:
+  FullSourceStore(const ::std::string &directory, const ::std::string &filename,
+                  ::llvm::StringRef original)
+      : directory(directory), filename(filename), original(original) {}
+
+  virtual bool save(IdType id, const EditScript &script,
+                    const MutantOrigin &origin) {
+    ::std::string mutantPath =
+        this->directory + ::std::to_string(id) + ::chimera::fs::pathSep;
+    // Create folder for this mutant
+    ::chimera::fs::createDirectories(mutantPath);
+    ::std::string code;
+    return script.apply(this->original, code) &&
+           writeFile(mutantPath + this->filename, code);
+  }
+
+  virtual bool keep(IdType id, const EditScript &script,
+                    const MutantOrigin &origin) {
+    return ::llvm::sys::fs::exists(this->getPath(id)) ||
+           this->save(id, script, origin);
+  }
+
+  virtual void remove(IdType id) {
+    ::llvm::sys::fs::remove(this->getPath(id));
+    // The directory stays if the mutator wrote its reports in it
+    ::llvm::sys::fs::remove(this->directory + ::std::to_string(id));
+  }
+
+ private:
+  /// @brief Path of the source code of a mutant
+  ::std::string getPath(IdType id) const {
+    return this->directory + ::std::to_string(id) + ::chimera::fs::pathSep +
+           this->filename;
+  }
+
+  ::std::string directory;    ///< Output directory of the source
+  ::std::string filename;     ///< File name of the source
+  ::llvm::StringRef original; ///< Original source code
+};
+
+/// @brief The original source once and each mutant as its edit script
+class PatchStore : public MutantStore {
+ public:
+  explicit PatchStore(const ::std::string &directory)
+      : patchesDirectory(directory + "patches" + ::chimera::fs::pathSep) {}
+
+  virtual bool save(IdType id, const EditScript &script,
+                    const MutantOrigin &origin) {
+    return writeFile(this->getPath(id), script.str());
+  }
+
+  virtual bool keep(IdType id, const EditScript &script,
+                    const MutantOrigin &origin) {
+    return ::llvm::sys::fs::exists(this->getPath(id)) ||
+           this->save(id, script, origin);
+  }
+
+  virtual void remove(IdType id) { ::llvm::sys::fs::remove(this->getPath(id)); }
+
+ private:
+  /// @brief Path of the edit script of a mutant
+  ::std::string getPath(IdType id) const {
+    return this->patchesDirectory + ::std::to_string(id) + ".edit";
+  }
+
+  ::std::string patchesDirectory; ///< Directory of the edit scripts
+};
+
+/// @brief All the edit scripts in a single file, with a fixed width index
+class PackStore : public MutantStore {
+ public:
+  explicit PackStore(const ::std::string &directory)
+      : indexPath(directory + "mutants.idx"), packError(),
+        pack(directory + "mutants.pack", packError, ::llvm::sys::fs::F_None),
+        closed(false) {}
+
+  virtual ~PackStore() { this->close(); }
+
+  /// @brief If the pack file has been opened
+  bool isOpen() const { return !this->packError; }
+
+  virtual bool save(IdType id, const EditScript &script,
+                    const MutantOrigin &origin) {
+    if (this->closed || id == 0) {
+      return false;
+    }
+    // A higher order mutant is saved again at each order, only its last
+    // version is written on close
+    PendingScript &pending = this->scripts[id];
+    pending.serialized = script.str();
+    pending.origin = origin;
+    return true;
+  }
+
+  virtual bool close() {
+    if (this->closed) {
+      return true;
+    }
+    this->closed = true;
+    ::std::vector<PackIndexRecord> records;
+    if (!this->scripts.empty()) {
+      PackIndexRecord empty;
+      ::std::memset(&empty, 0, sizeof(empty));
+      records.resize(this->scripts.rbegin()->first + 1, empty);
+    }
+    for (const auto &pending : this->scripts) {
+      const ::std::string &serialized = pending.second.serialized;
+      const MutantOrigin &origin = pending.second.origin;
+      PackIndexRecord &record = records[pending.first];
+      record.offset = this->pack.tell();
+      record.length = serialized.size();
+      record.id = pending.first;
+      ::llvm::MD5 hash;
+      hash.update(serialized);
+      ::llvm::MD5::MD5Result digest;
+      hash.final(digest);
+      ::std::memcpy(record.digest, digest, sizeof(record.digest));
+      record.line = origin.line;
+      record.column = origin.column;
+      ::std::memset(record.mutator, 0, sizeof(record.mutator));
+      ::std::memcpy(record.mutator, origin.mutator.data(),
+                    ::std::min(origin.mutator.size(), sizeof(record.mutator)));
+      this->pack << serialized;
+    }
+    this->scripts.clear();
+    this->pack.close();
+    if (this->pack.has_error()) {
+      ChimeraLogger::error("An error occurred writing the mutants pack");
+      this->pack.clear_error();
+      return false;
+    }
+    ::std::error_code fileError;
+    ::llvm::raw_fd_ostream index(this->indexPath, fileError,
+                                 ::llvm::sys::fs::F_None);
+    if (fileError) {
+      ChimeraLogger::error("An error occurred during the file opening: " +
+                           fileError.message());
+      return false;
+    }
+    PackIndexHeader header;
+    ::std::memcpy(header.magic, packIndexMagic, sizeof(header.magic));
+    header.recordSize = sizeof(PackIndexRecord);
+    header.recordCount = records.size();
+    index.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!records.empty()) {
+      index.write(reinterpret_cast<const char *>(records.data()),
+                  records.size() * sizeof(PackIndexRecord));
+    }
+    index.close();
+    if (index.has_error()) {
+      ChimeraLogger::error("An error occurred writing the mutants index");
+      index.clear_error();
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  /// @brief The last version of the edit script of a mutant
+  struct PendingScript {
+    ::std::string serialized; ///< The serialized edit script
+    MutantOrigin origin;      ///< Where the mutant comes from
+  };
+
+  ::std::string indexPath;     ///< Path of the index
+  ::std::error_code packError; ///< Error opening the pack
+  ::llvm::raw_fd_ostream pack; ///< The pack of the edit scripts
+  /// @brief The edit scripts written on close, by mutant id
+  ::std::map<IdType, PendingScript> scripts;
+  bool closed; ///< If the pack and the index have been written
+};
+} // End anonymous namespace
+
+/// @brief Save the original source the edit scripts are applied on
+static bool saveOriginal(const ::std::string &directory,
+                         const ::std::string &filename,
+                         ::llvm::StringRef original) {
+  ::std::string originalDirectory =
+      directory + "original" + ::chimera::fs::pathSep;
+  return ::chimera::fs::createDirectories(originalDirectory) &&
+         writeFile(originalDirectory + filename, original);
+}
+
+::std::unique_ptr<MutantStore> chimera::mutant::MutantStore::create(
+    MutantStoreMode mode, const ::std::string &directory,
+    const ::std::string &filename, ::llvm::StringRef original) {
+  switch (mode) {
+  case FullMutantStore:
+    return ::std::unique_ptr<MutantStore>(
+        new FullSourceStore(directory, filename, original));
+  case PatchMutantStore:
+    if (!saveOriginal(directory, filename, original) ||
+        !::chimera::fs::createDirectories(directory + "patches")) {
+      return nullptr;
+    }
+    return ::std::unique_ptr<MutantStore>(new PatchStore(directory));
+  case PackMutantStore: {
+    if (!saveOriginal(directory, filename, original)) {
+      return nullptr;
+    }
+    ::std::unique_ptr<PackStore> store(new PackStore(directory));
+    if (!store->isOpen()) {
+      return nullptr;
+    }
+    return ::std::move(store);
+  }
+  }
+  return nullptr;
+}
+
+/// @brief Read the edit script of a mutant from a pack store
+/// @return 1 if found, 0 if there is no pack store, -1 if the mutant isn't in
+///         the store or the store is corrupted
+static int readPackedScript(const ::std::string &directory, IdType id,
+                            ::std::string &serialized) {
+  ::std::string indexPath = directory + "mutants.idx";
+  auto index = ::llvm::MemoryBuffer::getFile(indexPath);
+  if (!index) {
+    if (index.getError() == ::std::errc::no_such_file_or_directory) {
+      return 0;
+    }
+    ChimeraLogger::error("Couldn't read " + indexPath + ": " +
+                         index.getError().message());
+    return -1;
+  }
+  // The index is mapped in memory, the record is at a fixed position
+  ::llvm::StringRef indexData = (*index)->getBuffer();
+  PackIndexHeader header;
+  if (indexData.size() < sizeof(header)) {
+    ChimeraLogger::error("Corrupted pack index " + indexPath +
+                         ": truncated header");
+    return -1;
+  }
+  ::std::memcpy(&header, indexData.data(), sizeof(header));
+  if (::std::memcmp(header.magic, packIndexMagic, sizeof(header.magic)) != 0 ||
+      header.recordSize != sizeof(PackIndexRecord) ||
+      indexData.size() <
+          sizeof(header) + header.recordCount * sizeof(PackIndexRecord)) {
+    ChimeraLogger::error("Corrupted pack index " + indexPath +
+                         ": bad header or truncated records");
+    return -1;
+  }
+  if (id >= header.recordCount) {
+    ChimeraLogger::error("Mutant " + ::std::to_string(id) + " isn't in " +
+                         indexPath);
+    return -1;
+  }
+  PackIndexRecord record;
+  ::std::memcpy(&record,
+                indexData.data() + sizeof(header) +
+                    id * sizeof(PackIndexRecord),
+                sizeof(record));
+  if (record.id != id) {
+    ChimeraLogger::error("Mutant " + ::std::to_string(id) + " isn't in " +
+                         indexPath);
+    return -1;
+  }
+  ::std::string packPath = directory + "mutants.pack";
+  auto pack = ::llvm::MemoryBuffer::getFileSlice(packPath, record.length,
+                                                 record.offset);
+  if (!pack) {
+    ChimeraLogger::error("Couldn't read mutant " + ::std::to_string(id) +
+                         " from " + packPath + ": " +
+                         pack.getError().message());
+    return -1;
+  }
+  serialized = (*pack)->getBuffer();
+  return 1;
+}
+
+bool chimera::mutant::MutantStore::materialize(const ::std::string &directory,
+                                               const ::std::string &filename,
+                                               IdType id,
+                                               ::std::string &code) {
+  // Pack or patch store
+  ::std::string original, patch;
+  int packed = readPackedScript(directory, id, patch);
+  if (packed < 0) {
+    return false;
+  }
+  if (packed > 0 ||
+      readFile(directory + "patches" + ::chimera::fs::pathSep +
+                   ::std::to_string(id) + ".edit",
+               patch)) {
+    EditScript script;
+    if (!readFile(directory + "original" + ::chimera::fs::pathSep + filename,
+                  original) ||
+        !EditScript::read(patch, script) || !script.apply(original, code)) {
+      ChimeraLogger::error("Corrupted patch store in " + directory);
+      return false;
+    }
+    return true;
+  }
+  // Full store
+  return readFile(directory + ::std::to_string(id) + ::chimera::fs::pathSep +
+                      filename,
+                  code);
+}
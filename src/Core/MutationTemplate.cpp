@@ -26,14 +26,27 @@
 //===----------------------------------------------------------------------===//
 
 #include "Core/MutationTemplate.h"
+#include "Stats.h"
 #include "Tooling/FrontendActions.h"
 #include "Tooling/CompilationDatabaseUtils.h"
 
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <future>
 
 using namespace clang;
 using namespace clang::tooling;
@@ -42,121 +55,107 @@ using namespace chimera;
 using namespace chimera::mutator;
 using namespace chimera::m_operator;
 using namespace chimera::log;
+using chimera::stats::ScopedTimer;
 
 #define DEBUG_TYPE "mutation_template"
 
-static mutant::IdType mutantCounterInitial = 1;
+static const mutant::IdType firstMutantId = 1;
 
+/// @brief If a character can be part of an identifier
+static bool isIdentifierChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
 
-// FIXME: When a function name is not found -> LLVM IO ERROR.
-
-///////////////////////////////////////////////////////////////////////////////
-/// @brief    This class manages the creation and deletion of rewriter objects
-/// @details  It works with a reservation mechanism:
-///            - a slot can be reserved, when the slot is required a rewriter is
-///            (eventually created and)
-///              returned,
-///            - if the slot doesn't exist a local over-writtable slot is used.
-///            The max number of local
-///              slots is given by \tparam localSlots, the max pallelisms in
-///              using the Rewriters managed by this
-///              class.
-/// @tparam   ContentType It must have a ctor without arguments
-/// FIXME Generalize it
-template <typename IdType, typename ContentType, int localSlots = 1>
-class SlotManager {
-  using RewriterPtr =
-      ::std::unique_ptr<Rewriter>; ///< Rewriter pointer abstraction
-  using SlotType = ::std::unique_ptr<ContentType>;
-
-public:
-  SlotManager() {}
-
-  /// @brief Try to reserve a slot, eg if you knew you're going to use it
-  /// @param toReserve Which slot should be reserved
-  /// @return bool If the reservation succeeds
-  bool reserve(IdType toReserve) {
-    auto retval = this->slots.insert(std::pair<IdType, SlotType>(
-        toReserve, ::std::unique_ptr<ContentType>(nullptr)));
-    DEBUG(::llvm::dbgs() << "Reserving id:" << toReserve
-                         << ".Operation: " << retval.second << "\n");
-    return retval.second;
-  }
-
-  /// @brief Set a slot, differs from reserve because it also fills the slot
-  /// @param toReserve Which slot should be reserved
-  /// @param content The content of the slot
-  /// @return bool If the reservation succeeds
-  bool setSlot(IdType toReserve, const ContentType &content) {
-    auto retval = this->slots.insert(std::pair<IdType, SlotType>(
-        toReserve, ::std::unique_ptr<ContentType>(new ContentType(content))));
-    return retval.second;
-  }
-
-  /// @brief Try to reserve a slot using the local slot if it is valid.
-  /// @return bool If the reservation succeeds
-  bool reserveLocalSlot() {
-    // Check localSlot
-    if (this->localSlot.second) {
-      auto retval = this->slots.insert(::std::move(localSlot));
-      return retval.second;
+/// @brief The names declared by the declarations a mutator inserts before a
+///        function, as "::fap::FloatPrecTy OP_1(8,23);" or "int stride1 = 1;"
+/// @details The name is the last identifier before the initializer of each
+///          declaration. The preprocessor lines declare nothing.
+/// @return If every declaration has a name
+static bool getDeclaredNames(StringRef declarations,
+                             std::vector<std::string> &names) {
+  SmallVector<StringRef, 4> lines;
+  declarations.split(lines, '\n', -1, false);
+  std::string code;
+  for (StringRef line : lines) {
+    if (!line.ltrim().startswith("#")) {
+      code += line;
+      code += "\n";
     }
-    return false;
   }
-
-  /// @brief Try to release a previously reserved slot
-  /// @param toRelease
-  /// @return bool If the release succeeds
-  bool release(IdType toRelease) { return this->slots.erase(toRelease) == 1; }
-
-  /// @brief Retrieve a reserved slot if exists
-  /// @param slotId
-  /// @param content
-  /// @return bool If it exist
-  bool getReservedSlot(IdType slotId, ContentType &content) {
-    try {
-      content = *(this->slots.at(slotId));
-      return true;
-    } catch (const std::out_of_range &oor) { // Not present
-      return false;
+  int depth = 0;
+  size_t declarationBegin = 0, nameEnd = StringRef::npos;
+  for (size_t i = 0; i < code.size(); ++i) {
+    char c = code[i];
+    if (depth == 0 && nameEnd == StringRef::npos &&
+        (c == '(' || c == '=' || c == '[' || c == '{' || c == ';')) {
+      nameEnd = i;
     }
-  }
-
-  /// @brief It creates the content of a slot, of a local one if wasn't reserved
-  /// or of the reserved one.
-  ///        If the content of the reserved slot already exist, it returns it.
-  /// @param mngr
-  /// @param lang
-  /// @param wasReserved If the slot was reserved
-  /// @return Rewriter A rewriter
-  template <typename... Args>
-  ContentType &getSlot(IdType slot, bool &wasReserved, Args &&... args) {
-    wasReserved = true;
-    try {
-      // Try to access the object, seeing if manages an object
-      if (!this->slots.at(slot)) {
-        // Create one
-        this->slots.at(slot)
-            .reset(new ContentType(::std::forward<Args>(args)...));
+    if (c == '(' || c == '[' || c == '{') {
+      ++depth;
+    } else if (c == ')' || c == ']' || c == '}') {
+      --depth;
+    } else if (c == ';' && depth == 0) {
+      StringRef declarator = StringRef(code)
+                                 .slice(declarationBegin, nameEnd)
+                                 .rtrim();
+      size_t nameBegin = declarator.size();
+      while (nameBegin > 0 && isIdentifierChar(declarator[nameBegin - 1])) {
+        --nameBegin;
       }
+      if (nameBegin == declarator.size() ||
+          std::isdigit(static_cast<unsigned char>(declarator[nameBegin]))) {
+        return false;
+      }
+      names.push_back(declarator.substr(nameBegin).str());
+      declarationBegin = i + 1;
+      nameEnd = StringRef::npos;
+    }
+  }
+  // Nothing but blanks after the last declaration
+  return StringRef(code).substr(declarationBegin).trim().empty();
+}
 
-      return *(this->slots.at(slot));
-    } catch (const std::out_of_range &oor) {
-      wasReserved = false;
-      // Renew the localSlot
-      localSlot.first = slot;
-      localSlot.second.reset(new ContentType(::std::forward<Args>(args)...));
-      return *localSlot.second;
+/// @brief Append a suffix to the identifiers of code that are in names
+static std::string renameIdentifiers(StringRef code,
+                                     const std::vector<std::string> &names,
+                                     const std::string &suffix) {
+  if (names.empty()) {
+    return code.str();
+  }
+  std::string renamed;
+  size_t i = 0;
+  while (i < code.size()) {
+    if (!isIdentifierChar(code[i])) {
+      renamed += code[i++];
+      continue;
+    }
+    size_t end = i;
+    while (end < code.size() && isIdentifierChar(code[end])) {
+      ++end;
+    }
+    StringRef token = code.slice(i, end);
+    renamed += token;
+    if (std::find(names.begin(), names.end(), token) != names.end()) {
+      renamed += suffix;
     }
+    i = end;
   }
+  return renamed;
+}
 
-private:
-  // Each rewriter is associated with a key, in this case the mutantId
-  ::std::map<IdType, SlotType> slots;
-  ::std::pair<IdType, SlotType> localSlot; // Local slot
-};
 
-static SlotManager<mutant::IdType, Rewriter> rwManager;
+// FIXME: When a function name is not found -> LLVM IO ERROR.
+
+namespace clang {
+namespace ast_matchers {
+/// @brief Matches the functions selected by a chimera::FunctionFilter
+AST_MATCHER_P(FunctionDecl, isSelectedBy,
+              std::shared_ptr<const chimera::FunctionFilter>, filter) {
+  return filter->matches(Node);
+}
+} // End clang::ast_matchers namespace
+} // End clang namespace
+
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief MatchCallback child : The callback called for the mutator's matchers
@@ -167,11 +166,12 @@ public:
    * has been created
    */
   MutatorMatcherCallback(MutationTemplate &mutTempl, MutatorPtr mutator,
-                         mutant::IdType staticId = 0,
-                         std::string tempDirName = "temp")
+                         const m_operator::IdType &operatorId,
+                         mutant::IdType staticId = 0)
       : MatchCallback(), mutationTemplate(mutTempl), mutator(mutator),
-        sourceManager(nullptr), context(nullptr), localMutantId(staticId),
-        tempDirName(tempDirName) {}
+        operatorId(operatorId),
+        statsSource(mutTempl.getTargetName()),
+        sourceManager(nullptr), context(nullptr), localMutantId(staticId) {}
 
   /// @brief Set the local pointer to the source manager
   /// @param manager A pointer to the source manager
@@ -204,38 +204,47 @@ public:
   ///          When it's default it means either is a FOM or a mutations has not
   ///          succeeded yet.
   ///          Only when it isn't initialized if this method is called it is set
-  ///          the the mutantCounter.
+  ///          the the next id of the mutation template.
   ///          If the mutant fails some step, the value is set back to default,
   ///          until at least one mutations succeeds
   Rewriter &initializeMutant(mutant::IdType &id) {
     id = this->localMutantId;
     if (id == 0) {
       // As for the FOM mutator
-      id = this->mutationTemplate.mutantCounter;
+      id = this->mutationTemplate.getMutantIdAllocator().peek();
     }
     bool wasReserved;
-    return rwManager.getSlot(id, wasReserved, *(this->sourceManager),
-                             this->context->getLangOpts());
+    return this->mutationTemplate.getRewriterManager().getSlot(
+        id, wasReserved, *(this->sourceManager), this->context->getLangOpts());
   }
 
   /// @brief Called when a mutant has been created, it finalizes the used
   /// information.
   ///        It performs the following:
-  ///         - Set the local mutant id incrementing the mutant counter, or only
+  ///         - Set the local mutant id allocating a new id, or only
   ///         the latter
   ///         - Reserve the used rewriter
-  void finalizeMutant() {
+  /// @return The id of the mutant
+  mutant::IdType finalizeMutant() {
+    mutant::IdType id = this->localMutantId;
     if (this->mutator->isHom()) {
       // HOM
-      if (this->localMutantId == 0) {
+      if (id == 0) {
         // If the localMutantId was 0, it has to be set and ...
-        this->localMutantId = this->mutationTemplate.mutantCounter++;
+        id = this->localMutantId =
+            this->mutationTemplate.getMutantIdAllocator().allocate();
         // ... the rewriter reserved
-        rwManager.reserveLocalSlot();
+        this->mutationTemplate.getRewriterManager().reserveLocalSlot();
       }
-    } else
-      // FOM, increment and do nothing
-      this->mutationTemplate.mutantCounter++;
+    } else {
+      // FOM, allocate and do nothing
+      mutant::IdType allocated =
+          this->mutationTemplate.getMutantIdAllocator().allocate();
+      if (id == 0) {
+        id = allocated;
+      }
+    }
+    return id;
   }
 
   /// @brief Apply mutations and report and/or save them according to the state
@@ -244,6 +253,9 @@ public:
   /// mutants haven't to be saved,
   ///          this functions shouldn't be called.
   ///          It works with both FOM and HOM mutators.
+  ///          Each mutant is snapshotted and its check submitted to the
+  ///          mutation template, the report and the saving are performed by
+  ///          commitMutant once the check has completed.
   /// @param Result MatchResult object
   void applyMutations(const MatchFinder::MatchResult &Result) {
     // Local variables
@@ -252,168 +264,385 @@ public:
         matchedNode; // It will contain the matched node
     // Matched node validty
     bool nodeIsValid = this->mutator->getMatchedNode(Result, matchedNode);
+    // The function containing the mutations
+    const FunctionDecl *functionDecl =
+        Result.Nodes.getNodeAs<FunctionDecl>("functionDecl");
+    SourceLocation location;
+    if (nodeIsValid) {
+      location = matchedNode.getSourceRange().getBegin();
+    }
 
     // Loop on mutator types
     for (MutatorType i = 0; i < this->mutator->getTypes(); ++i) {
+      // An HOM mutator without a reserved id gets it, and its rewriter, from
+      // the first committed mutant: the previous checks have to be committed
+      // before continuing
+      bool sequential = this->mutator->isHom() && this->localMutantId == 0;
+      if (sequential) {
+        this->mutationTemplate.waitChecks();
+      }
+
       // Per mutation type actions:
       // * Set local mutantId and retrieve a rewriter
       Rewriter &localRw = this->initializeMutant(mutantId);
 
       // Verbose messages
       if (nodeIsValid) {
-        ChimeraLogger::verbose(
-            "[" + std::to_string(mutantId) + "] Applying mutation in " +
-            matchedNode.getSourceRange().getBegin().printToString(
-                *(this->sourceManager)));
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "] Applying mutation in " +
+                        location.printToString(*(this->sourceManager)));
       } else {
-        ChimeraLogger::verbose("[" + std::to_string(mutantId) +
-                               "] Applying mutation in <invalid>. Report for "
-                               "this mutant will not be generated");
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "] Applying mutation in <invalid>. Report for "
+                        "this mutant will not be generated");
       }
 
       // Apply the mutation calling the mutate method
-      this->mutator->mutate(Result, i, localRw);
+      ::std::string code;
+      ::std::shared_ptr<const mutant::EditScript> script;
+      {
+        ScopedTimer timer(this->statsSource, this->operatorId,
+                          this->mutator->getIdentifier(), "mutate");
+        if (timer.isTraced() && functionDecl != nullptr) {
+          timer.setDetail(functionDecl->getQualifiedNameAsString());
+        }
+        this->mutator->mutate(Result, i, localRw);
+
+        // Check if actually a rewriteBuffer has been created, id est if the
+        // buffer has been modified.
+        if (localRw.getRewriteBufferFor(
+                localRw.getSourceMgr().getMainFileID()) != nullptr) {
+          // The source file has been somehow modified, continue
+          // Snapshot the mutant as edits of the original source, the
+          // rewriter will be modified or replaced by the next mutations
+          // before the check completes
+          ::llvm::raw_string_ostream mutantStream(code);
+          localRw.getEditBuffer(localRw.getSourceMgr().getMainFileID())
+              .write(mutantStream);
+          mutantStream.flush();
+          script = ::std::make_shared<const mutant::EditScript>(
+              mutant::EditScript::diff(
+                  this->mutationTemplate.getOriginalSource(), code));
+        }
+      }
 
-      // Check if actually a rewriteBuffer has been created, id est if the
-      // buffer has been modified.
-      if (localRw.getRewriteBufferFor(localRw.getSourceMgr().getMainFileID()) !=
-          nullptr) {
-        // The source file has been somehow modified, continue
+      if (script) {
+        this->count(stats::EditCounter);
         // Check if the mutant is valid
-        ChimeraLogger::verboseAndIncr("[" + std::to_string(mutantId) +
-                                      "][ RUN  ] Checking mutant");
-
-        if (this->checkMutant(localRw)) {
-          ChimeraLogger::verbosePreDecr("[" + std::to_string(mutantId) +
-                                        "][ PASS ] Checking mutant");
-
-          // The mutant is valid, continue
-          // Save the report if the matched node is valid
-          if (nodeIsValid) {
-            this->createReportEntry(
-                mutantId, Result.Nodes.getNodeAs<FunctionDecl>("functionDecl")
-                              ->getNameAsString(),
-                matchedNode.getSourceRange().getBegin(),
-                this->mutator->getIdentifier(), i);
-          }
-
-          // Save the mutant to file if this feature is enabled
-          if (this->mutationTemplate.isGenerateMutants()) {
-            this->saveMutant(mutantId, localRw);
-          } else {
-            ChimeraLogger::verbose("[" + std::to_string(mutantId) +
-                                   "] Saving disabled");
-          }
-          // Increment mutantCounter if the mutator is not an HOM
-          this->finalizeMutant();
-        } else {
-          // The mutant is invalid
-          ChimeraLogger::verbosePreDecr("[" + std::to_string(mutantId) +
-                                        "][ FAIL ] Checking mutant");
-#ifdef _CHIMERA_DEBUG_
-          // DEBUG
-          rw.getEditBuffer(rw.getSourceMgr().getMainFileID())
-              .write(llvm::outs());
-#endif
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "][ RUN  ] Checking mutant");
+        ::std::string functionName = functionDecl->getNameAsString();
+        CompileCommand checkCommand = this->getCheckCommand();
+        this->mutationTemplate.submitCheck(
+            checkCommand, script,
+            functionDecl->getQualifiedNameAsString(),
+            stats::PhaseScope{this->operatorId, this->mutator->getIdentifier()},
+            [this, script, functionName, location, nodeIsValid,
+             i](bool passed, mutant::IdType aliasOf, mutant::IdType keptId) {
+              return this->commitMutant(passed, aliasOf, keptId, *script,
+                                        functionName, location, nodeIsValid,
+                                        i);
+            },
+            // Only a mutant with its own id can be reported as alias
+            !this->mutator->isHom() && this->localMutantId == 0,
+            this->mutationTemplate.getCheckBatchSize() > 1
+                ? this->getBatchableFunction(functionDecl, *script, code)
+                : nullptr,
+            this->mutationTemplate.isIncremental()
+                ? this->getIncrementalKey(*Result.Context, functionDecl,
+                                          checkCommand, *script, i)
+                : "");
+
+        if (sequential) {
+          this->mutationTemplate.waitChecks();
         }
       } else {
-        ChimeraLogger::verbose("[" + std::to_string(mutantId) +
-                               "] Application didn't produce changes");
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "] Application didn't produce changes");
       }
       //      this->deleteLocalRewriter();  // Delete the rewriter
     }
   }
 
-  /// @brief Save a mutant given an unique id and the Rewriter that contains the
-  /// sourceBuffer
-  /// @param id Mutant unique id
-  /// @param rewriter Rewriter object with RewriteBuffer that contains the
-  /// source modification
-  /// @return If the Mutant is correctly saved
-  bool saveMutant(mutant::IdType id, Rewriter &rewriter) {
-    std::string filename(this->mutationTemplate.getTargetFilename().data());
-    std::string mutantPath = this->mutationTemplate.getTargetOutputDirectory() +
-                             std::to_string(id) + chimera::fs::pathSep;
-    std::string filePath = mutantPath + filename;
-    ChimeraLogger::verbose("[" + std::to_string(id) + "] Saving mutant in " +
-                           clang::tooling::getAbsolutePath(filePath));
-
-    // Create folder for this mutant
-    chimera::fs::createDirectories(mutantPath);
-
-    // Save mutant on file
-    // Create the file stream
-    ::std::error_code fileError;
-    llvm::raw_fd_ostream file(filePath.c_str(), fileError,
-                              llvm::sys::fs::F_Text);
-    if (!file.has_error()) {
-      rewriter.getEditBuffer(rewriter.getSourceMgr().getMainFileID())
-          .write(file);
-    } else {
-      ChimeraLogger::error("An error occurred during the file opening: " +
-                           fileError.message());
+  /// @brief Offsets of a function in the original source, from its start to
+  ///        the end of its last token
+  /// @return If the function is spelled in the main file, out of macros
+  bool getFunctionOffsets(const FunctionDecl *function, size_t &beginOffset,
+                          size_t &endOffset) {
+    const SourceManager &sm = *(this->sourceManager);
+    SourceLocation begin = function->getLocStart();
+    SourceLocation end = Lexer::getLocForEndOfToken(
+        function->getLocEnd(), 0, sm, this->context->getLangOpts());
+    if (begin.isMacroID() || end.isInvalid() || !sm.isInMainFile(begin) ||
+        !sm.isInMainFile(end)) {
       return false;
     }
-    file.close(); // Close the file stream
+    beginOffset = sm.getFileOffset(begin);
+    endOffset = sm.getFileOffset(end);
     return true;
   }
 
-  /// @brief Check syntactically a mutant identified by id
-  /// @param id Mutant unique id
-  /// @return If the mutant passes the check
-  bool checkMutant(Rewriter &rw) {
-    // Create a temp directory and a temp file
-    std::string tempDir = this->mutationTemplate.getTargetOutputDirectory() +
-                          this->tempDirName + chimera::fs::pathSep;
-    std::string tempFilePath =
-        tempDir + this->mutationTemplate.getTargetFilename().data();
-
-    // Create the directory
-    chimera::fs::createDirectories(tempDir);
-
-    // Create temp file
-    ::std::error_code fileError;
-    ::llvm::raw_fd_ostream tempFile(tempFilePath, fileError,
-                                    llvm::sys::fs::F_Text);
-    if (!tempFile.has_error()) {
-      // Write the temp file
-      rw.getEditBuffer(rw.getSourceMgr().getMainFileID()).write(tempFile);
-      tempFile.close(); // Close the file stream
-
-      ChimeraLogger::verbose("Building CompilationDatabase");
-      // Get compileCommands for this target
-      CompileCommand command = this->mutationTemplate.getCompileCommand();
-
-      // Modify the compile command
-      ::chimera::cd_utils::changeCompileCommandTarget(
-          command, this->mutationTemplate.getTargetPath(), tempFilePath, true);
-
-      // Adding compile commands from the mutator
-      const ::std::vector<::std::string> &mutatorCompileCommands =
-          this->mutator->getAdditionalCompileCommands();
-      command.CommandLine.insert(command.CommandLine.end(),
-                                 mutatorCompileCommands.begin(),
-                                 mutatorCompileCommands.end());
+  /// @brief Key of a mutant in the incremental analysis
+  /// @details The hash of the mutated function, of its text, of the check
+  ///          command and of the incremental context of the template, with
+  ///          the mutator, the type and the edits relative to the start of
+  ///          the function: the key doesn't change when the bodies of other
+  ///          functions of the source do. The HOM mutants, spanning several
+  ///          functions, and the mutants with edits out of the function have
+  ///          no key.
+  /// @return The key, empty if the mutant has none
+  ::std::string getIncrementalKey(ASTContext &context,
+                                  const FunctionDecl *function,
+                                  const CompileCommand &command,
+                                  const mutant::EditScript &script,
+                                  MutatorType type) {
+    size_t beginOffset, endOffset;
+    if (function == nullptr || this->mutator->isHom() || script.empty() ||
+        !this->getFunctionOffsets(function, beginOffset, endOffset) ||
+        script.getEdits().front().offset < beginOffset ||
+        script.getEdits().back().offset + script.getEdits().back().length >
+            endOffset) {
+      return "";
+    }
+    const ::std::string &incrementalContext =
+        this->mutationTemplate.getIncrementalContext(context);
+    if (incrementalContext.empty()) {
+      return "";
+    }
+    ::llvm::StringRef separator("\0", 1);
+    ::std::string &functionHash = this->functionHashes[function];
+    if (functionHash.empty()) {
+      llvm::MD5 hash;
+      hash.update(incrementalContext);
+      hash.update(separator);
+      hash.update(command.Directory);
+      for (const auto &argument : command.CommandLine) {
+        hash.update(separator);
+        hash.update(argument);
+      }
+      hash.update(separator);
+      hash.update(::llvm::StringRef(this->mutationTemplate.getOriginalSource())
+                      .slice(beginOffset, endOffset));
+      llvm::MD5::MD5Result digest;
+      hash.final(digest);
+      llvm::SmallString<32> digestString;
+      llvm::MD5::stringifyResult(digest, digestString);
+      functionHash = digestString.str();
+    }
+    mutant::EditScript relative;
+    for (const mutant::Edit &edit : script.getEdits()) {
+      relative.addEdit(edit.offset - beginOffset, edit.length,
+                       edit.replacement);
+    }
+    llvm::MD5 hash;
+    hash.update(functionHash);
+    hash.update(separator);
+    hash.update(this->mutator->getIdentifier());
+    hash.update(separator);
+    hash.update(std::to_string(type));
+    hash.update(separator);
+    hash.update(relative.str());
+    llvm::MD5::MD5Result digest;
+    hash.final(digest);
+    llvm::SmallString<32> digestString;
+    llvm::MD5::stringifyResult(digest, digestString);
+    return digestString.str();
+  }
+
+  /// @brief Extract from the mutant the mutated function, to check it in batch
+  /// @details Only free functions, not templates, whose mutations are all
+  ///          strictly inside their body can be checked in batch. The
+  ///          renamed copy of the function keeps its declaration, so it
+  ///          compiles if and only if the mutant does in place; an edit of
+  ///          the declaration or out of the function is checked alone.
+  ///          The declarations inserted at the start of the function, as the
+  ///          globals of the operators, are kept apart: each copy gets its
+  ///          own, renamed with it.
+  /// @param function The mutated function
+  /// @param script The mutant, as edits of the original source
+  /// @param code The source code of the mutant
+  /// @return The mutated function, nullptr if it can't be checked in batch
+  ::std::shared_ptr<const BatchableFunction>
+  getBatchableFunction(const FunctionDecl *function,
+                       const mutant::EditScript &script,
+                       ::llvm::StringRef code) {
+    if (function == nullptr || script.empty() ||
+        isa<CXXMethodDecl>(function) ||
+        function->getTemplatedKind() != FunctionDecl::TK_NonTemplate ||
+        !function->getDeclName().isIdentifier()) {
+      return nullptr;
+    }
+    const SourceManager &sm = *(this->sourceManager);
+    SourceLocation name = function->getLocation();
+    const CompoundStmt *body =
+        dyn_cast_or_null<CompoundStmt>(function->getBody());
+    size_t beginOffset, endOffset;
+    if (name.isMacroID() || body == nullptr ||
+        body->getLBracLoc().isMacroID() || body->getRBracLoc().isMacroID() ||
+        !this->getFunctionOffsets(function, beginOffset, endOffset)) {
+      return nullptr;
+    }
+    ::llvm::StringRef original = this->mutationTemplate.getOriginalSource();
+    size_t nameOffset = sm.getFileOffset(name);
+    size_t nameLength = function->getName().size();
+    size_t bodyBegin = sm.getFileOffset(body->getLBracLoc()) + 1;
+    size_t bodyEnd = sm.getFileOffset(body->getRBracLoc());
+
+    // The insertions at the start of the function, then the changed region
+    // of the original source, between the braces
+    auto batchable = ::std::make_shared<BatchableFunction>();
+    const ::std::vector<mutant::Edit> &edits = script.getEdits();
+    size_t first = 0;
+    for (; first < edits.size() && edits[first].offset == beginOffset &&
+           edits[first].length == 0;
+         ++first) {
+      batchable->declarations += edits[first].replacement;
+    }
+    if (first < edits.size() &&
+        (edits[first].offset < bodyBegin ||
+         edits.back().offset + edits.back().length > bodyEnd)) {
+      return nullptr;
+    }
+    if (!getDeclaredNames(batchable->declarations,
+                          batchable->declaredNames)) {
+      return nullptr;
+    }
+
+    // Map the original offsets on the mutant, after the inserted declarations
+    // and after the changed region they are shifted by the size difference
+    size_t mutantBeginOffset = beginOffset + batchable->declarations.size();
+    size_t mutantEndOffset = endOffset + code.size() - original.size();
+    batchable->insertOffset = endOffset;
+    batchable->text = code.slice(mutantBeginOffset, mutantEndOffset).str();
+    batchable->nameOffset = nameOffset - beginOffset;
+    batchable->nameLength = nameLength;
+    return batchable;
+  }
+
+  /// @brief Report and/or save a checked mutant
+  /// @details The commits happen in the same order of the mutations, so the
+  ///          mutant id is the one the mutant would have had checking it
+  ///          inside applyMutations.
+  ///          A duplicate mutant is only reported, with the id of the
+  ///          identical mutant.
+  /// @param passed If the mutant passed the check
+  /// @param aliasOf The id of the identical mutant, 0 if not a duplicate
+  /// @param keptId The id kept from the previous incremental analysis, 0 if
+  ///        the mutant is new
+  /// @param script The mutant, as edits of the original source
+  /// @param functionName The name of the mutated function
+  /// @param location The location of the matched node
+  /// @param nodeIsValid If the matched node is valid
+  /// @param type The mutator type that produced the mutant
+  /// @return The id of the mutant, 0 if it failed the check
+  mutant::IdType commitMutant(bool passed, mutant::IdType aliasOf,
+                              mutant::IdType keptId,
+                              const mutant::EditScript &script,
+                              const ::std::string &functionName,
+                              const SourceLocation &location,
+                              bool nodeIsValid, MutatorType type) {
+    mutant::IdType mutantId = this->localMutantId;
+    if (mutantId == 0) {
+      // As for the FOM mutator
+      mutantId = this->mutationTemplate.getMutantIdAllocator().peek();
+    }
+    this->count(!passed ? stats::FailedCounter
+                        : aliasOf != 0 ? stats::DuplicateCounter
+                                       : stats::PassedCounter);
+    if (passed && aliasOf != 0) {
+      CHIMERA_VERBOSE("[" + std::to_string(aliasOf) +
+                      "][ SKIP ] Duplicate mutant");
+      if (nodeIsValid) {
+        this->createReportEntry(aliasOf, functionName, location,
+                                this->mutator->getIdentifier(), type, true);
+      }
+      return aliasOf;
+    }
+    if (passed) {
+      // Allocate the id if the mutator is not an HOM and the mutant hasn't
+      // kept its id
+      mutantId = keptId != 0 ? keptId : this->finalizeMutant();
+      CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                      "][ PASS ] Checking mutant");
+
+      // The mutant is valid, continue
+      // Save the report if the matched node is valid
+      if (nodeIsValid) {
+        this->createReportEntry(mutantId, functionName, location,
+                                this->mutator->getIdentifier(), type);
+      }
 
+      // Save the mutant if this feature is enabled
+      if (this->mutationTemplate.isGenerateMutants()) {
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "] Saving mutant");
+        mutant::MutantOrigin origin;
+        origin.mutator = this->mutator->getIdentifier();
+        origin.line = origin.column = 0;
+        if (nodeIsValid) {
+          FullSourceLoc fullLoc(location, *(this->sourceManager));
+          origin.line = fullLoc.getSpellingLineNumber();
+          origin.column = fullLoc.getSpellingColumnNumber();
+        }
+        ScopedTimer timer(this->statsSource, this->operatorId,
+                          origin.mutator, "save");
+        if (timer.isTraced()) {
+          timer.setDetail("mutant " + std::to_string(mutantId));
+        }
+        if (!this->mutationTemplate.saveMutant(mutantId, script, origin)) {
+          ChimeraLogger::error("Couldn't save the mutant " +
+                               std::to_string(mutantId));
+        }
+      } else {
+        CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                        "] Saving disabled");
+      }
+      ::std::string code;
+      if (this->mutationTemplate.isGenerateSchemata() &&
+          script.apply(this->mutationTemplate.getOriginalSource(), code)) {
+        this->mutationTemplate.addSchemataMutant(mutantId, code);
+      }
+      return mutantId;
+    } else {
+      // The mutant is invalid
+      CHIMERA_VERBOSE("[" + std::to_string(mutantId) +
+                      "][ FAIL ] Checking mutant");
 #ifdef _CHIMERA_DEBUG_
-      chimera::cd_utils::dump(std::cout, commands); // Debug
+      // DEBUG
+      script.write(llvm::outs());
 #endif
-      ChimeraLogger::verbose("Running syntax check");
-
-      // TODO A frontend action can be called directly on code in string format
-      // clang::tooling::runToolOnCode uses the -fsyntax-only code that check
-      // only the syntax
-      // BUT show always errors for inclusion not found, because compile
-      // commands aren't passed in input.
-      return chimera::checkSyntaxAction(
-                 command, this->mutationTemplate.getTargetPath()) == 0;
-    } else {
-      ChimeraLogger::error("An error occurred during the file opening: " +
-                           fileError.message());
-      return false;
+      return 0;
     }
   }
 
+  /// @brief Build the compile command to check syntactically the mutants
+  /// @details The mutated main file is remapped in memory on the target
+  ///          path, so the check doesn't write any temporary file.
+  /// @return The compile command for the target with the additional commands
+  ///         of the mutator
+  CompileCommand getCheckCommand() {
+    // Get compileCommands for this target
+    CompileCommand command = this->mutationTemplate.getCompileCommand();
+
+    // Modify the compile command, the target has to be the absolute path
+    // remapped on the in-memory buffer
+    ::chimera::cd_utils::changeCompileCommandTarget(
+        command, this->mutationTemplate.getTargetPath(),
+        this->mutationTemplate.getTargetPath(), true);
+
+    // Adding compile commands from the mutator
+    const ::std::vector<::std::string> &mutatorCompileCommands =
+        this->mutator->getAdditionalCompileCommands();
+    command.CommandLine.insert(command.CommandLine.end(),
+                               mutatorCompileCommands.begin(),
+                               mutatorCompileCommands.end());
+
+#ifdef _CHIMERA_DEBUG_
+    chimera::cd_utils::dump(std::cout, command); // Debug
+#endif
+    return command;
+  }
+
   /// @brief Delete a mutant that fails the check
   /// @param id Mutant unique id
   void deleteMutant(mutant::IdType id) {
@@ -432,19 +661,25 @@ public:
   ///          - Mutant Id
   ///          - Location
   ///          - Mutator Identifier
+  ///          - The id of the identical mutant, for an alias entry
   void createReportEntry(mutant::IdType id, const std::string &functionName,
                          const SourceLocation &l,
                          const std::string &mutatorIdentifier,
-                         mutator::MutatorType type) {
-    ChimeraLogger::verbose("[" + std::to_string(id) +
-                           "] Mutant report: Location: " +
-                           l.printToString(*(this->sourceManager)));
+                         mutator::MutatorType type, bool alias = false) {
+    CHIMERA_VERBOSE("[" + std::to_string(id) +
+                    "] Mutant report: Location: " +
+                    l.printToString(*(this->sourceManager)));
     // Create a fullSource -> a SourceLocation with an associatd SourceManager
     FullSourceLoc fullLoc(l, *(this->sourceManager));
-    this->mutationTemplate.getReportStream()
-        << id << "," << functionName << "," << fullLoc.getSpellingLineNumber()
-        << "," << fullLoc.getSpellingColumnNumber() << "," << mutatorIdentifier
-        << "," << type << std::endl;
+    mutant::ReportEntry entry;
+    entry.id = id;
+    entry.function = functionName;
+    entry.line = fullLoc.getSpellingLineNumber();
+    entry.column = fullLoc.getSpellingColumnNumber();
+    entry.mutator = mutatorIdentifier;
+    entry.type = type;
+    entry.aliasOf = alias ? id : 0;
+    this->mutationTemplate.addReportEntry(entry);
   }
 
   ///////////////////////////////////////////////////////////////////////////////
@@ -456,15 +691,32 @@ public:
    * to generate the mutants.
    */
   virtual void run(const MatchFinder::MatchResult &Result) {
-    ChimeraLogger::verboseAndIncr("Coarse grain matching from " +
-                                  this->mutator->getIdentifier());
+    ScopedTimer callbackTimer(this->statsSource, this->operatorId,
+                              this->mutator->getIdentifier(), "callback");
+    if (callbackTimer.isTraced()) {
+      const FunctionDecl *function =
+          Result.Nodes.getNodeAs<FunctionDecl>("functionDecl");
+      if (function != nullptr) {
+        callbackTimer.setDetail(function->getQualifiedNameAsString());
+      }
+    }
+    CHIMERA_VERBOSE_AND_INCR("Coarse grain matching from " +
+                             this->mutator->getIdentifier());
     // Set the local sourceManager
     this->setSourceManager(Result.SourceManager);
     this->setASTContext(Result.Context);
     // Apply fine grained matching rules
-    if (this->mutator->match(Result)) {
+    this->count(stats::CallbackCounter);
+    bool matched;
+    {
+      ScopedTimer timer(this->statsSource, this->operatorId,
+                        this->mutator->getIdentifier(), "match");
+      matched = this->mutator->match(Result);
+    }
+    if (matched) {
+      this->count(stats::FineMatchCounter);
       // It is very likely that mutants have to be created -> general mutant
-      ChimeraLogger::verboseAndIncr("Fine grain matching [ PASS ]");
+      CHIMERA_VERBOSE_AND_INCR("Fine grain matching [ PASS ]");
 
       // With the introduction of the HOM mutators, this phase has to be
       // specialized
@@ -472,7 +724,7 @@ public:
 
       ChimeraLogger::decrActualVLevel();
     } else {
-      ChimeraLogger::verbose("Fine grain matching [ FAIL ]");
+      CHIMERA_VERBOSE("Fine grain matching [ FAIL ]");
     }
     ChimeraLogger::decrActualVLevel();
   }
@@ -481,33 +733,41 @@ public:
    */
   virtual void onEndOfTranslationUnit() {
     //    ChimeraLogger::verbose(" [ RUN  ] Cleaning up");
+    // The pending mutants have to be committed while the AST is still alive
+    this->mutationTemplate.waitChecks();
     // Call callbacks: if the mutator is HOM, and so the localMutantId is != 0.
     // Finally the mutant directory exists only if the mutants have been
     // generated.
     if (this->mutator->isHom() && this->localMutantId != 0 &&
-        this->mutationTemplate.isGenerateMutants()) {
+        (this->mutationTemplate.isGenerateMutants() ||
+         this->mutationTemplate.isGenerateSchemata())) {
       // At this point the mutant has been created
-      this->mutator->onCreatedMutant(
+      ::std::string mutantDir =
           this->mutationTemplate.getTargetOutputDirectory() +
-          ::std::to_string(this->localMutantId) + ::chimera::fs::pathSep);
+          ::std::to_string(this->localMutantId) + ::chimera::fs::pathSep;
+      // With the schemata only, the directory holds the mutator reports
+      ::chimera::fs::createDirectories(mutantDir);
+      ScopedTimer timer(this->statsSource, this->operatorId,
+                        this->mutator->getIdentifier(), "onCreatedMutant");
+      this->mutator->onCreatedMutant(mutantDir);
     }
 
-    // Delete temp folder, deleting all files inside
-    ::std::string tempDir = this->mutationTemplate.getTargetOutputDirectory() +
-                            this->tempDirName + chimera::fs::pathSep;
-    // Delete temp file for syntax checking
-    ::llvm::sys::fs::remove(tempDir +
-                            this->mutationTemplate.getTargetFilename());
-
-    // Delete the temp directory
-    ::llvm::sys::fs::remove(tempDir);
-
-       ChimeraLogger::verbose(" [ DONE ] Cleaning up");
+    CHIMERA_VERBOSE(" [ DONE ] Cleaning up");
   }
 
 private:
+  /// @brief Count an outcome of the matchers of this mutator
+  void count(stats::MatcherCounter counter) {
+    stats::StatsRegistry::get().count(this->statsSource, this->operatorId,
+                                      this->mutator->getIdentifier(), counter);
+  }
+
   MutationTemplate &mutationTemplate; ///< Reference to the mutation template
   MutatorPtr mutator;                 ///< Mutator related to this Matcher
+  m_operator::IdType operatorId;      ///< Operator of the mutator
+  ::std::string statsSource;          ///< Source the times are accounted to
+  /// Hashes of the mutated functions, for the incremental analysis
+  ::std::map<const FunctionDecl *, ::std::string> functionHashes;
   SourceManager *sourceManager;       ///< Pointer to the source manager
   const ASTContext *context;
   /// @brief In case of HOM mutator, this attribute could be externally provided
@@ -515,21 +775,99 @@ private:
   ///        influences the retrieve
   ///        of the rewriter.
   mutant::IdType localMutantId;
-  const ::std::string tempDirName; ///< Temporary directory
 };
 
 ///////////////////////////////////////////////////////////////////////////////
-// Class MutationTemplate Implementation
+/// @brief ASTConsumer running a MatchFinder on the translation unit, as the
+///        one of newFrontendActionFactory, recording the parse and the
+///        traversal times
+class TimedMatchConsumer : public ASTConsumer {
+public:
+  TimedMatchConsumer(MatchFinder &finder, const ::std::string &source,
+                     std::shared_ptr<const FunctionFilter> bodyFilter)
+      : finder(finder), source(source), bodyFilter(bodyFilter), parse() {}
+
+  /// The bodies are skipped only if SkipFunctionBodies is set
+  bool shouldSkipFunctionBody(Decl *D) override {
+    const FunctionDecl *function = D->getAsFunction();
+    return function == nullptr || !this->bodyFilter ||
+           !this->bodyFilter->matches(*function);
+  }
+
+  void HandleTranslationUnit(ASTContext &context) override {
+    stats::StatsRegistry &registry = stats::StatsRegistry::get();
+    if (registry.isEnabled()) {
+      registry.addTime(this->source, "", "", "parse", this->parse.elapsed());
+    }
+    // The callbacks run inside the traversal
+    ScopedTimer timer(this->source, "traversal");
+    this->finder.matchAST(context);
+  }
+
+private:
+  MatchFinder &finder;
+  ::std::string source;    ///< Source the times are accounted to
+  /// Functions whose bodies are parsed, all if null
+  std::shared_ptr<const FunctionFilter> bodyFilter;
+  stats::Stopwatch parse;  ///< Started when the parse starts
+};
+
+/// @brief FrontendAction creating a TimedMatchConsumer
+/// @details With a body filter, the parser skips the bodies of the functions
+///          it doesn't select.
+class TimedMatchAction : public ASTFrontendAction {
+public:
+  TimedMatchAction(MatchFinder &finder, const ::std::string &source,
+                   std::shared_ptr<const FunctionFilter> bodyFilter)
+      : finder(finder), source(source), bodyFilter(bodyFilter) {}
+
+protected:
+  bool BeginInvocation(CompilerInstance &CI) override {
+    if (this->bodyFilter) {
+      CI.getFrontendOpts().SkipFunctionBodies = true;
+    }
+    return ASTFrontendAction::BeginInvocation(CI);
+  }
+
+  ::std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &,
+                                                   StringRef) override {
+    return ::llvm::make_unique<TimedMatchConsumer>(this->finder, this->source,
+                                                   this->bodyFilter);
+  }
+
+private:
+  MatchFinder &finder;
+  ::std::string source;
+  std::shared_ptr<const FunctionFilter> bodyFilter;
+};
+
+/// @brief FrontendActionFactory creating a TimedMatchAction
+class TimedMatchActionFactory : public FrontendActionFactory {
+public:
+  TimedMatchActionFactory(MatchFinder &finder, const ::std::string &source,
+                          std::shared_ptr<const FunctionFilter> bodyFilter)
+      : finder(finder), source(source), bodyFilter(bodyFilter) {}
+
+  FrontendAction *create() override {
+    return new TimedMatchAction(this->finder, this->source, this->bodyFilter);
+  }
 
-static SlotManager<m_operator::IdType, mutant::IdType> idManager;
+private:
+  MatchFinder &finder;
+  ::std::string source;
+  std::shared_ptr<const FunctionFilter> bodyFilter;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Class MutationTemplate Implementation
 
 // Private methods
 void chimera::MutationTemplate::initMutantIds_() {
   // Reset slot manager
-  idManager = SlotManager<m_operator::IdType, mutant::IdType>();
-  rwManager = SlotManager<mutant::IdType, Rewriter>();
-  // Reset mutant counter
-  this->mutantCounter = mutantCounterInitial;
+  this->idManager = SlotManager<m_operator::IdType, mutant::IdType>();
+  this->rwManager = SlotManager<mutant::IdType, Rewriter>();
+  // Reset mutant ids
+  this->mutantIds.reset(firstMutantId);
   // Loop on operators to find HOM and reserve their ids.
   // The hypothesis is that they are going to be used, ie at least one mutation.
   mutant::IdType reservedId;
@@ -537,105 +875,217 @@ void chimera::MutationTemplate::initMutantIds_() {
     if (op.second->isHom()) {
       // Set a slot that binds operator and an identifier, that will be used for
       // all its HOM mutators
-      reservedId = this->mutantCounter;
-      if (!idManager.setSlot(op.second->getIdentifier(), reservedId) ||
-          !rwManager.reserve(reservedId)) {
+      reservedId = this->mutantIds.allocate();
+      if (!this->idManager.setSlot(op.second->getIdentifier(), reservedId) ||
+          !this->rwManager.reserve(reservedId)) {
         ChimeraLogger::fatal("Couldn't reserve a mutantId for an operator. "
                              "Maybe a mutantId duplicate or memory issues.");
       }
-      this->mutantCounter++;
     }
   }
 }
 
-/// @brief Add matchers to finder from mutators vector using functionName as
-/// function's name filter.
-/// @param finder The Match finder in which add the Matchers
-/// @param operatorId The operator id of which take the matchers
-/// @param functionName The name of the target function/method
-void chimera::MutationTemplate::addMatchers_(
-    MatchFinder &finder, const m_operator::IdType &operatorId,
-    const std::string &functionName) {
-  // Manage FOM and HOM operator, the mutators are managed inside the callback
-  mutant::IdType reservedId = 0;
-  if (this->operators.at(operatorId)->isHom()) {
-    // Retrieve reservedId
-    if (!idManager.getReservedSlot(operatorId, reservedId)) {
-      ChimeraLogger::fatal("An id wasn't reserved for this operator.");
-    }
-  }
-  const auto &mutators = this->operators[operatorId]->getMutators();
-  // Check functionName
-  internal::Matcher<NamedDecl> functionHasName = anything();
-  if (functionName != "") {
-    // Filter on function's name
-    functionHasName = hasName(functionName);
-  }
-  // Loop on mutators
-  for (unsigned j = 0; j < mutators.size(); ++j) {
-    // Create the callback for this mutator
-    // TODO Manage deallocation of callbackObj
-    MutatorMatcherCallback *callbackObj =
-        new MutatorMatcherCallback(*this, mutators[j], reservedId);
-    /// The Mutation Template passes to the mutator through bind() the
-    /// functionDecl reference.
-    /// This DeclarationMatcher is a wrapper to reduce the mutations only to the
-    /// functions with
-    /// body.
-    DeclarationMatcher functionDefMatcher = anything();
-    std::string functionDefId =
-        "functionDecl"; /// Id for the matchCallback bind.
-    /* Switch on mutator matcher type */
-    switch (mutators[j]->getMatcherType()) {
-    case StatementMatcherType:
-      functionDefMatcher =
-          functionDecl(functionHasName, isDefinition(),
-                       forEachDescendant(mutators[j]->getStatementMatcher()))
-              .bind(functionDefId);
-      break;
-    case DeclarationMatcherType:
-      functionDefMatcher =
-          functionDecl(functionHasName, isDefinition(),
-                       forEachDescendant(mutators[j]->getDeclarationMatcher()))
-              .bind(functionDefId);
-      break;
-    default:
-      llvm_unreachable("Matcher Type unsupported");
-      break;
+/// @brief Translate a glob, with * and ?, in an extended regular expression
+static std::string globToRegex(StringRef glob) {
+  std::string regex;
+  for (char c : glob) {
+    if (c == '*') {
+      regex += ".*";
+    } else if (c == '?') {
+      regex += '.';
+    } else {
+      if (StringRef(".[\\()+{|^$").find(c) != StringRef::npos) {
+        regex += '\\';
+      }
+      regex += c;
     }
-    // Add the matcher to the finder
-    finder.addMatcher(functionDefMatcher, callbackObj);
   }
+  return regex;
 }
 
-/// @brief Add matchers from local operators filtered by identifier
-void chimera::MutationTemplate::addMatchers_(
-    MatchFinder &finder, const std::vector<m_operator::IdType> &operatorIds,
+bool chimera::FunctionFilter::add(const std::string &function) {
+  Pattern pattern;
+  std::string regex;
+  StringRef entry(function);
+  if (entry.startswith("re:")) {
+    regex = entry.drop_front(3).str();
+    pattern.qualified = true;
+  } else if (entry.find_first_of("*?") != StringRef::npos) {
+    if (entry.startswith("::")) {
+      entry = entry.drop_front(2);
+    }
+    regex = globToRegex(entry);
+    pattern.qualified = entry.find("::") != StringRef::npos;
+  } else {
+    this->names.insert(function);
+    return true;
+  }
+  pattern.regex = std::make_shared<llvm::Regex>("^(" + regex + ")$");
+  std::string error;
+  if (!pattern.regex->isValid(error)) {
+    ChimeraLogger::error("Invalid function pattern " + function + ": " +
+                         error);
+    return false;
+  }
+  this->patterns.push_back(pattern);
+  return true;
+}
+
+void chimera::FunctionFilter::merge(const FunctionFilter &other) {
+  this->all = this->all || other.all;
+  this->names.insert(other.names.begin(), other.names.end());
+  this->patterns.insert(this->patterns.end(), other.patterns.begin(),
+                        other.patterns.end());
+  this->results.clear();
+}
+
+bool chimera::FunctionFilter::matches(const FunctionDecl &function) const {
+  if (this->all) {
+    return true;
+  }
+  auto result = this->results.find(&function);
+  if (result == this->results.end()) {
+    result =
+        this->results.insert(std::make_pair(&function, selects(function)))
+            .first;
+  }
+  return result->second;
+}
+
+bool chimera::FunctionFilter::selects(const FunctionDecl &function) const {
+  if (this->all) {
+    return true;
+  }
+  std::string name = function.getNameAsString();
+  std::string qualifiedName = function.getQualifiedNameAsString();
+  if (!this->names.empty()) {
+    // The whole qualified name and each of its scope suffixes, down to the
+    // unqualified name
+    if (this->names.count("::" + qualifiedName) > 0) {
+      return true;
+    }
+    for (size_t begin = 0; begin != std::string::npos;) {
+      if (this->names.count(qualifiedName.substr(begin)) > 0) {
+        return true;
+      }
+      begin = qualifiedName.find("::", begin);
+      if (begin != std::string::npos) {
+        begin += 2;
+      }
+    }
+    if (this->names.count(name) > 0) {
+      return true;
+    }
+  }
+  for (const Pattern &pattern : this->patterns) {
+    if (pattern.regex->match(pattern.qualified ? qualifiedName : name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// @brief Select functionName, or all the functions if it is empty, for the
+///        operators
+/// @param functions The functions of each operator, updated
+/// @param operatorIds The operators, CHIMERA_ALL_OPERATORS for all of them
+/// @param functionName The name of the target function/method
+void chimera::MutationTemplate::addFunctions_(
+    OperatorFunctionsMap &functions,
+    const std::vector<m_operator::IdType> &operatorIds,
     const std::string &functionName) {
+  std::vector<m_operator::IdType> selected;
   // Check if there is CHIMERA_ALL_OPERATORS
-  auto operatorId = std::find(operatorIds.begin(), operatorIds.end(),
-                              "CHIMERA_ALL_OPERATORS");
-  if (operatorId != operatorIds.end()) {
+  if (std::find(operatorIds.begin(), operatorIds.end(),
+                "CHIMERA_ALL_OPERATORS") != operatorIds.end()) {
     // Found, Apply all operators
     ChimeraLogger::verbose("Found CHIMERA_ALL_OPERATORS");
-    {
-      // Load matcher from all operators
-      for (auto op = this->operators.begin(); op != this->operators.end();
-           ++op) {
-        this->addMatchers_(finder, op->first, functionName);
-      }
+    for (const auto &op : this->operators) {
+      selected.push_back(op.first);
     }
   } else {
-    // Load matcher from filtered operators
-    for (operatorId = operatorIds.begin(); operatorId != operatorIds.end();
-         ++operatorId) {
-      /// Take the operator's mutators and add their matcher to
-      /// MutationTemplate's MatchFinder.
-      std::cout << "Operator : " << *operatorId << std::endl;
+    for (const auto &operatorId : operatorIds) {
+      std::cout << "Operator : " << operatorId << std::endl;
       // Check if the operator exists
-      auto op = this->operators.find(*operatorId);
-      if (op != this->operators.end()) {
-        this->addMatchers_(finder, op->first, functionName);
+      if (this->operators.find(operatorId) != this->operators.end()) {
+        selected.push_back(operatorId);
+      }
+    }
+  }
+  for (const auto &operatorId : selected) {
+    FunctionFilter &filter = functions[operatorId];
+    if (functionName == "") {
+      filter.selectAll();
+    } else {
+      // An invalid pattern is reported and selects no function
+      filter.add(functionName);
+    }
+  }
+}
+
+/// @brief Add the matchers of the mutators of the operators to finder
+/// @details Each mutator matcher is added once, whatever the number of
+///          functions of its operator: the finder walks the translation unit
+///          once, evaluating all the matchers at each node. The nearest
+///          enclosing function definition is bound to "functionDecl", the
+///          node is matched only if the filter of the operator selects it.
+/// @param finder The Match finder in which add the Matchers
+/// @param functions The functions of each operator to add
+void chimera::MutationTemplate::addMatchers_(
+    MatchFinder &finder, const OperatorFunctionsMap &functions) {
+  /// The Mutation Template passes to the mutator through bind() the
+  /// functionDecl reference, only the functions with body are mutated
+  const std::string functionDefId = "functionDecl";
+  for (const auto &entry : functions) {
+    const m_operator::IdType &operatorId = entry.first;
+    // Manage FOM and HOM operator, the mutators are managed inside the
+    // callback
+    mutant::IdType reservedId = 0;
+    if (this->operators.at(operatorId)->isHom()) {
+      // Retrieve reservedId
+      if (!this->idManager.getReservedSlot(operatorId, reservedId)) {
+        ChimeraLogger::fatal("An id wasn't reserved for this operator.");
+      }
+    }
+    // A single matcher for all the functions of the operator. The nearest
+    // enclosing definition is bound, then filtered: the methods of a local
+    // class aren't selected by the function they are defined in
+    bool all = entry.second.isAll();
+    DeclarationMatcher functionDefMatcher =
+        functionDecl(isDefinition()).bind(functionDefId);
+    DeclarationMatcher selectedMatcher = functionDecl(
+        equalsBoundNode(functionDefId),
+        isSelectedBy(std::make_shared<FunctionFilter>(entry.second)));
+    const auto &mutators = this->operators[operatorId]->getMutators();
+    // Loop on mutators
+    for (unsigned j = 0; j < mutators.size(); ++j) {
+      // Create the callback for this mutator
+      // TODO Manage deallocation of callbackObj
+      MutatorMatcherCallback *callbackObj =
+          new MutatorMatcherCallback(*this, mutators[j], operatorId, reservedId);
+      /* Switch on mutator matcher type */
+      switch (mutators[j]->getMatcherType()) {
+      case StatementMatcherType:
+        finder.addMatcher(
+            all ? stmt(mutators[j]->getStatementMatcher(),
+                       hasAncestor(functionDefMatcher))
+                : stmt(mutators[j]->getStatementMatcher(),
+                       hasAncestor(functionDefMatcher),
+                       hasAncestor(selectedMatcher)),
+            callbackObj);
+        break;
+      case DeclarationMatcherType:
+        finder.addMatcher(
+            all ? decl(mutators[j]->getDeclarationMatcher(),
+                       hasAncestor(functionDefMatcher))
+                : decl(mutators[j]->getDeclarationMatcher(),
+                       hasAncestor(functionDefMatcher),
+                       hasAncestor(selectedMatcher)),
+            callbackObj);
+        break;
+      default:
+        llvm_unreachable("Matcher Type unsupported");
+        break;
       }
     }
   }
@@ -648,7 +1098,8 @@ void chimera::MutationTemplate::addMatchers_(
 ///         1 Not OK - Some error occured
 int chimera::MutationTemplate::run(clang::ast_matchers::MatchFinder &finder) {
   int retval = 1; // Default error
-  if (isGenerateMutants() || isGenerateMutantsReport()) {
+  if (isGenerateMutants() || isGenerateMutantsReport() ||
+      isGenerateSchemata()) {
     ChimeraLogger::verboseAndIncr("[ RUN  ] Internal tool");
     
     // Create output folder
@@ -660,19 +1111,92 @@ int chimera::MutationTemplate::run(clang::ast_matchers::MatchFinder &finder) {
       return 1;
     }
     
-    // Open report stream
-    if (this->openReportStream("report.csv")) {
+    // Load the original source, the mutants are built as edits of it
+    auto original = llvm::MemoryBuffer::getFile(this->targetPath);
+    if (!original) {
+      ChimeraLogger::fatal("Couldn't read " + this->targetPath);
+      return 1;
+    }
+    this->originalSource = (*original)->getBuffer();
+    if (this->incremental) {
+      this->loadIncremental_();
+    }
+    if (this->isGenerateMutants()) {
+      this->mutantStore = mutant::MutantStore::create(
+          this->mutantStoreMode, this->getTargetOutputDirectory(),
+          this->getTargetFilename().str(), this->originalSource);
+      if (!this->mutantStore) {
+        ChimeraLogger::fatal("Couldn't create the mutants store");
+        return 1;
+      }
+    }
+    if (this->isGenerateSchemata()) {
+      // The mutants are stored as differences from the original
+      this->schemata.reset(new mutant::MutantSchemata(this->originalSource));
+    }
+
+    // Open report sinks
+    if (this->openReport()) {
+      if (this->validationJobs > 1) {
+        ChimeraLogger::verbose("Checking mutants with " +
+                               std::to_string(this->validationJobs) +
+                               " threads");
+        this->validationPool.reset(new llvm::ThreadPool(this->validationJobs));
+      }
       // retval = this->tool.run(newFrontendActionFactory(&finder).get());
       // Run the ClangTool on a Finder FrontendAction
       // FIXME: Instead of using the ClantTool it coulbe be used directly the
       // CompilerInvocation.
       
-      retval = (ClangTool(::chimera::cd_utils::FlexibleCompilationDatabase(
-                              this->compileCommand),
-                          this->targetPath))
-                   .run(newFrontendActionFactory(&finder).get());
+      if (this->astCache) {
+        retval = this->runOnCachedAST_(finder);
+      } else {
+        TimedMatchActionFactory factory(
+            finder, this->getTargetName(), this->bodyFilter);
+        retval = (ClangTool(::chimera::cd_utils::FlexibleCompilationDatabase(
+                                this->compileCommand),
+                            this->targetPath))
+                     .run(&factory);
+      }
 
-      this->closeReportStream();
+      this->waitChecks();
+      this->validationPool.reset();
+      if (this->incremental) {
+        ChimeraLogger::verbose("Reused the checks of " +
+                               std::to_string(this->reusedChecks) +
+                               " mutants of unchanged functions, kept " +
+                               std::to_string(this->keptIds.size()) +
+                               " ids, " +
+                               std::to_string(this->unchangedIds.size()) +
+                               " mutants unchanged");
+        this->removeStaleMutants_();
+        if (!this->saveIncremental_()) {
+          ChimeraLogger::error("Couldn't save the incremental analysis");
+        }
+        this->previousChecks.clear();
+        this->currentChecks.clear();
+        this->previousIds.clear();
+        this->committedIds.clear();
+        this->keptIds.clear();
+        this->unchangedIds.clear();
+        this->incrementalContext.clear();
+      }
+      if (this->mutantStore && !this->mutantStore->close()) {
+        ChimeraLogger::error("Couldn't complete the mutants store");
+      }
+      this->mutantStore.reset();
+      if (!this->closeReport()) {
+        ChimeraLogger::error("Couldn't write the report");
+      }
+      if (this->schemata) {
+        this->saveSchemata_();
+        this->schemata.reset();
+      }
+      this->originalSource.clear();
+      this->mutantDigests.clear();
+      // The preambles are valid only for this analysis
+      this->preambleCheckers.clear();
+      this->bodyFilter.reset();
 
       // After-run tasks:
       // * Call onEndOfTranslationUnit on mutators
@@ -688,7 +1212,7 @@ int chimera::MutationTemplate::run(clang::ast_matchers::MatchFinder &finder) {
       //          });
 
     } else {
-      ChimeraLogger::fatal("Couldn't open the report file");
+      ChimeraLogger::fatal("Couldn't open the report");
     }
     ChimeraLogger::decrActualVLevel();
     ChimeraLogger::verbose("[ DONE ] Internal tool");
@@ -699,11 +1223,286 @@ int chimera::MutationTemplate::run(clang::ast_matchers::MatchFinder &finder) {
   return retval;
 }
 
+/// @brief Run a MatchFinder on the AST of the target taken from the cache
+/// @details The load, or the parse on a cache miss, is recorded as the parse
+///          time of the target.
+/// @return 0 OK
+///         1 Not OK - The AST couldn't be built or it has errors
+int chimera::MutationTemplate::runOnCachedAST_(
+    clang::ast_matchers::MatchFinder &finder) {
+  const std::string source = this->getTargetName();
+  stats::Stopwatch parse;
+  bool cached;
+  std::unique_ptr<ASTUnit> unit =
+      this->astCache->getAST(this->compileCommand, this->targetPath, cached);
+  if (!unit) {
+    return 1;
+  }
+  stats::StatsRegistry &registry = stats::StatsRegistry::get();
+  if (registry.isEnabled()) {
+    registry.addTime(source, "", "", "parse", parse.elapsed());
+  }
+  {
+    // The callbacks run inside the traversal
+    ScopedTimer timer(source, "traversal");
+    finder.matchAST(unit->getASTContext());
+  }
+  return unit->getDiagnostics().hasErrorOccurred() ? 1 : 0;
+}
+
+/// @brief Path of the check results kept for the incremental analysis
+std::string chimera::MutationTemplate::getIncrementalPath_() const {
+  return this->getTargetOutputDirectory() + "incremental.txt";
+}
+
+/// @brief Load the mutants of the previous analysis
+/// @details Each line is "<key> <passed> <id> <content>", with passed 0 or 1,
+///          id 0 for a mutant without id and content "-" for a mutant not
+///          stored. The mutants without key, as the HOM ones, have key "-"
+///          and are kept only to remove them from the store when they
+///          disappear.
+///          A missing or malformed file is a first analysis.
+///          The ids from the first free one up to the highest kept one are
+///          left to the kept mutants, the new ones get the following ids.
+void chimera::MutationTemplate::loadIncremental_() {
+  this->previousChecks.clear();
+  this->currentChecks.clear();
+  this->previousIds.clear();
+  this->committedIds.clear();
+  this->keptIds.clear();
+  this->unchangedIds.clear();
+  this->incrementalContext.clear();
+  this->reusedChecks = 0;
+  this->firstKeptId = this->mutantIds.peek();
+  llvm::MD5 hash;
+  hash.update(this->originalSource);
+  llvm::MD5::MD5Result digest;
+  hash.final(digest);
+  llvm::SmallString<32> digestString;
+  llvm::MD5::stringifyResult(digest, digestString);
+  this->sourceDigest = digestString.str();
+
+  auto file = llvm::MemoryBuffer::getFile(this->getIncrementalPath_());
+  if (!file) {
+    return;
+  }
+  SmallVector<StringRef, 256> lines;
+  (*file)->getBuffer().split(lines, '\n', -1, false);
+  for (StringRef line : lines) {
+    SmallVector<StringRef, 4> fields;
+    line.split(fields, ' ');
+    KeptMutant kept;
+    if (fields.size() != 4 || fields[0].empty() ||
+        (fields[1] != "0" && fields[1] != "1") ||
+        fields[2].getAsInteger(10, kept.id) || fields[3].empty()) {
+      ChimeraLogger::warning("Malformed " + this->getIncrementalPath_() +
+                             ", all the mutants will be checked");
+      this->previousChecks.clear();
+      this->previousIds.clear();
+      return;
+    }
+    kept.passed = fields[1] == "1";
+    kept.content = fields[3];
+    if (kept.id != 0) {
+      this->previousIds.insert(kept.id);
+    }
+    if (fields[0] != "-") {
+      this->previousChecks[fields[0].str()] = kept;
+    }
+  }
+  if (!this->previousIds.empty() &&
+      *this->previousIds.rbegin() >= this->mutantIds.peek()) {
+    this->mutantIds.reset(*this->previousIds.rbegin() + 1);
+  }
+}
+
+/// @brief Save the check results of the current analysis, written aside and
+///        renamed as the reports
+/// @return If the results have been saved
+bool chimera::MutationTemplate::saveIncremental_() {
+  std::string path = this->getIncrementalPath_();
+  std::string temporary = path + ".tmp";
+  {
+    std::error_code fileError;
+    llvm::raw_fd_ostream file(temporary, fileError, llvm::sys::fs::F_Text);
+    if (fileError) {
+      ChimeraLogger::error("An error occurred during the file opening: " +
+                           fileError.message());
+      return false;
+    }
+    std::set<mutant::IdType> keyedIds;
+    for (const auto &check : this->currentChecks) {
+      file << check.first << (check.second.passed ? " 1 " : " 0 ")
+           << check.second.id << " "
+           << (check.second.id != 0 ? check.second.content : "-") << "\n";
+      keyedIds.insert(check.second.id);
+    }
+    // The mutants without key, to remove them when they disappear
+    for (mutant::IdType id : this->committedIds) {
+      if (keyedIds.count(id) == 0) {
+        file << "- 1 " << id << " -\n";
+      }
+    }
+    file.close();
+    if (file.has_error()) {
+      file.clear_error();
+      return false;
+    }
+  }
+  return !llvm::sys::fs::rename(temporary, path);
+}
+
+/// @brief MD5 of a mutant as the store of the current analysis saves it
+/// @return The digest, "-" if the mutants aren't stored
+std::string chimera::MutationTemplate::getMutantDigest_(
+    const mutant::EditScript &script) const {
+  if (!this->mutantStore) {
+    return "-";
+  }
+  // A full copy depends on the original source too
+  llvm::MD5 hash;
+  hash.update(std::to_string(this->mutantStoreMode));
+  hash.update(StringRef("\0", 1));
+  hash.update(this->sourceDigest);
+  hash.update(StringRef("\0", 1));
+  hash.update(script.str());
+  llvm::MD5::MD5Result digest;
+  hash.final(digest);
+  llvm::SmallString<32> digestString;
+  llvm::MD5::stringifyResult(digest, digestString);
+  return digestString.str();
+}
+
+/// @brief Take the id a passed mutant had in the previous analysis
+/// @details The id is kept if it's above the reserved ones and no other
+///          mutant of the current analysis took it. The stored mutant isn't
+///          written again if its content is unchanged.
+/// @param key The incremental key of the mutant
+/// @param content The MD5 of the mutant, see getMutantDigest_()
+/// @return The kept id, 0 if the mutant needs a new one
+mutant::IdType
+chimera::MutationTemplate::keepMutantId_(const std::string &key,
+                                         const std::string &content) {
+  auto previous = this->previousChecks.find(key);
+  if (previous == this->previousChecks.end() || !previous->second.passed ||
+      previous->second.id < this->firstKeptId ||
+      !this->keptIds.insert(previous->second.id).second) {
+    return 0;
+  }
+  if (content != "-" && previous->second.content == content) {
+    this->unchangedIds.insert(previous->second.id);
+  }
+  return previous->second.id;
+}
+
+/// @brief Remove from the store the mutants of the previous analysis that the
+///        current one didn't commit again
+void chimera::MutationTemplate::removeStaleMutants_() {
+  if (!this->mutantStore) {
+    return;
+  }
+  unsigned removed = 0;
+  for (mutant::IdType id : this->previousIds) {
+    if (this->committedIds.count(id) == 0) {
+      this->mutantStore->remove(id);
+      ++removed;
+    }
+  }
+  if (removed != 0) {
+    ChimeraLogger::verbose("Removed " + std::to_string(removed) +
+                           " mutants of the previous analysis");
+  }
+}
+
+const std::string &
+chimera::MutationTemplate::getIncrementalContext(ASTContext &context) {
+  if (!this->incrementalContext.empty()) {
+    return this->incrementalContext;
+  }
+  const SourceManager &sm = context.getSourceManager();
+  StringRef source = this->originalSource;
+  std::string deps;
+  if (!ASTCache::digestFiles(sm, false, deps)) {
+    ChimeraLogger::warning("Couldn't read the files included by " +
+                           this->targetPath +
+                           ", all the mutants will be checked");
+    return this->incrementalContext;
+  }
+
+  // The bodies of the functions defined in the target
+  std::vector<std::pair<size_t, size_t>> bodies;
+  auto functions = match(
+      functionDecl(isDefinition(), isExpansionInMainFile()).bind("function"),
+      context);
+  for (const BoundNodes &nodes : functions) {
+    const Stmt *body = nodes.getNodeAs<FunctionDecl>("function")->getBody();
+    if (body == nullptr) {
+      continue;
+    }
+    SourceLocation begin = body->getLocStart();
+    SourceLocation end = Lexer::getLocForEndOfToken(body->getLocEnd(), 0, sm,
+                                                    context.getLangOpts());
+    if (begin.isMacroID() || end.isInvalid() || end.isMacroID() ||
+        !sm.isInMainFile(begin) || !sm.isInMainFile(end) ||
+        sm.getFileOffset(end) > source.size()) {
+      continue;
+    }
+    bodies.emplace_back(sm.getFileOffset(begin), sm.getFileOffset(end));
+  }
+  std::sort(bodies.begin(), bodies.end());
+
+  StringRef separator("\0", 1);
+  llvm::MD5 hash;
+  size_t offset = 0;
+  for (const auto &body : bodies) {
+    // The nested bodies, as the lambda ones, are already out
+    if (body.first < offset) {
+      continue;
+    }
+    hash.update(source.slice(offset, body.first));
+    hash.update(separator);
+    offset = body.second;
+  }
+  hash.update(source.substr(offset));
+  hash.update(separator);
+  hash.update(deps);
+  hash.update(separator);
+  hash.update(std::to_string(this->syntaxCheckMode));
+  hash.update(this->skipFunctionBodies ? "1" : "0");
+  llvm::MD5::MD5Result digest;
+  hash.final(digest);
+  llvm::SmallString<32> digestString;
+  llvm::MD5::stringifyResult(digest, digestString);
+  this->incrementalContext = digestString.str();
+  return this->incrementalContext;
+}
+
+/// @brief Save the schemata of the current analysis
+/// @return If the schemata has been saved
+bool chimera::MutationTemplate::saveSchemata_() {
+  std::string schemataDir =
+      this->getTargetOutputDirectory() + "schemata" + chimera::fs::pathSep;
+  std::string filePath = schemataDir + this->getTargetFilename().data();
+  ChimeraLogger::verbose("Saving the schemata of " +
+                         std::to_string(this->schemata->size()) +
+                         " mutants in " + filePath);
+  chimera::fs::createDirectories(schemataDir);
+  std::error_code fileError;
+  llvm::raw_fd_ostream file(filePath.c_str(), fileError, llvm::sys::fs::F_Text);
+  if (fileError) {
+    ChimeraLogger::error("An error occurred during the file opening: " +
+                         fileError.message());
+    return false;
+  }
+  this->schemata->write(file);
+  return true;
+}
+
 // Public methods implementations
 chimera::MutationTemplate::MutationTemplate(
     const clang::tooling::CompileCommand &compileCommand,
     std::string targetPath, std::string outputDirectory)
-    : mutantCounter(mutantCounterInitial), compileCommand(compileCommand),
+    : compileCommand(compileCommand),
       // In order to avoid multiple execution and problems with locations (they
       // became invalid)
       // the tool it's build with a CompilationDatabase with only one
@@ -713,7 +1512,12 @@ chimera::MutationTemplate::MutationTemplate(
       // provided, independently of target
       tool(chimera::cd_utils::FlexibleCompilationDatabase(this->compileCommand),
            targetPath),
-      generateMutantsReport(false), generateMutants(false), reportStream() {
+      generateMutantsReport(false), generateMutants(false),
+      generateSchemata(false), mutantStoreMode(mutant::FullMutantStore),
+      syntaxCheckMode(PreambleSyntaxCheck), validationJobs(1),
+      checkBatchSize(1), deduplicateMutants(false), incremental(false),
+      reusedChecks(0), firstKeptId(firstMutantId), skipFunctionBodies(false),
+      mutantIds(firstMutantId), reportFormats(1, mutant::CsvReport) {
   chimera::log::ChimeraLogger::verboseAndIncr(
       "[ RUN  ] Building MutationTemplate");
   this->setOutputDirectory(outputDirectory);
@@ -733,13 +1537,13 @@ int chimera::MutationTemplate::analyze() {
   MatchFinder finder;
   ChimeraLogger::verbose(
       0, "FunOp Configuration file not set. Loading all operators.");
-  // Load matcher from operators
+  // Load matcher from operators, on all the functions
+  OperatorFunctionsMap functions;
   for (auto it = this->operators.begin(); it != this->operators.end(); ++it) {
-    { /// Take the operator's mutators and add their matcher to
-      /// MutationTemplate's MatchFinder.
-      this->addMatchers_(finder, it->first);
-    }
+    functions[it->first].selectAll();
   }
+  this->bodyFilter.reset();
+  this->addMatchers_(finder, functions);
   return this->run(finder);
 }
 
@@ -747,38 +1551,393 @@ int chimera::MutationTemplate::analyze(const conf::FunOpConfMap &map) {
   this->initMutantIds_();
   // Create a new finder
   MatchFinder finder;
-  std::string functionName = ""; // functionName
+  OperatorFunctionsMap functions;
   // Check if there is CHIMERA_ALL_FUNCTIONS specifier
   std::map<std::string, std::vector<std::string>>::const_iterator row =
       map.find("CHIMERA_ALL_FUNCTIONS");
   if (row != map.end()) {
     // Found, Apply to all functions
     ChimeraLogger::verbose("Found CHIMERA_ALL_FUNCTIONS");
-    { this->addMatchers_(finder, row->second, functionName); }
+    this->addFunctions_(functions, row->second, "");
   } else {
     // Not Found CHIMERA_ALL_FUNCTIONS
     // Iterate on map
     for (row = map.begin(); row != map.end(); ++row) {
-      functionName = row->first; // Filter by functionName
-      std::cout << "Function : " << functionName << std::endl;
-      this->addMatchers_(finder, row->second, functionName);
+      std::cout << "Function : " << row->first << std::endl;
+      this->addFunctions_(functions, row->second, row->first);
+    }
+  }
+  // Only the bodies of the functions of some operator are parsed
+  this->bodyFilter.reset();
+  if (this->skipFunctionBodies) {
+    std::shared_ptr<FunctionFilter> bodyFilter =
+        std::make_shared<FunctionFilter>();
+    for (const auto &entry : functions) {
+      bodyFilter->merge(entry.second);
+    }
+    if (!bodyFilter->isAll()) {
+      this->bodyFilter = bodyFilter;
     }
   }
+  // A matcher per mutator, whatever the number of functions
+  this->addMatchers_(finder, functions);
   return run(finder);
 }
 
+int chimera::MutationTemplate::checkSyntax(const CompileCommand &command,
+                                           llvm::StringRef code,
+                                           const std::string &functionName) {
+  if (this->syntaxCheckMode == FunctionSyntaxCheck && functionName != "") {
+    if (chimera::checkFunctionSyntaxAction(command, this->targetPath, code,
+                                           functionName) == 0) {
+      return 0;
+    }
+    // Confirm the failure on the whole file
+    CHIMERA_VERBOSE("Function check failed, checking the whole file");
+  }
+  if (this->syntaxCheckMode == PreambleSyntaxCheck) {
+    // Take an idle checker for this command, or create a new one
+    std::unique_ptr<PreambleSyntaxChecker> checker;
+    {
+      std::lock_guard<std::mutex> lock(this->preambleCheckersMutex);
+      auto &idleCheckers = this->preambleCheckers[command.CommandLine];
+      if (!idleCheckers.empty()) {
+        checker = std::move(idleCheckers.back());
+        idleCheckers.pop_back();
+      }
+    }
+    if (!checker) {
+      checker.reset(new PreambleSyntaxChecker(command, this->targetPath));
+    }
+    bool passed;
+    bool checked = checker->check(code, passed);
+    {
+      std::lock_guard<std::mutex> lock(this->preambleCheckersMutex);
+      this->preambleCheckers[command.CommandLine].push_back(std::move(checker));
+    }
+    if (checked) {
+      return passed ? 0 : 1;
+    }
+    // The translation unit couldn't be loaded, fall back on the full check
+  }
+  if (this->bodyFilter && functionName != "") {
+    // The mutation is in the body of a target function. The batches are
+    // parsed whole, their renamed copies aren't selected by the filter.
+    // The filter is shared by the validation threads, the results aren't
+    // memoized
+    std::shared_ptr<const FunctionFilter> bodyFilter = this->bodyFilter;
+    return chimera::checkSyntaxAction(
+        command, this->targetPath, code,
+        [bodyFilter](const FunctionDecl &function) {
+          return bodyFilter->selects(function);
+        });
+  }
+  return chimera::checkSyntaxAction(command, this->targetPath, code);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
-/// Report Stream Functions
-bool chimera::MutationTemplate::openReportStream(const char *reportName) {
-  this->reportStream.open(this->getTargetOutputDirectory() + reportName,
-                          std::ofstream::out);
-  return this->reportStream.is_open();
+/// Parallel validation Functions
+
+/// @brief The outcome of a committed mutant, shared with its duplicates
+struct chimera::MutationTemplate::CommittedMutant {
+  CommittedMutant() : passed(false), id(0) {}
+
+  bool passed;       ///< If the mutant passed the check
+  mutant::IdType id; ///< The mutant id, 0 if it hasn't one
+};
+
+/// @brief A submitted mutant check
+struct chimera::MutationTemplate::PendingCheck {
+  PendingCheck(const CompileCommand &command,
+               std::shared_ptr<const mutant::EditScript> script,
+               const std::string &functionName, const stats::PhaseScope &scope,
+               CommitFunction commit,
+               std::shared_ptr<const BatchableFunction> batchable,
+               const std::string &incrementalKey)
+      : command(command), script(script), functionName(functionName),
+        scope(scope), commit(commit), batchable(batchable),
+        incrementalKey(incrementalKey), passed(false) {}
+
+  CompileCommand command;                 ///< Compile command for the check
+  std::shared_ptr<const mutant::EditScript> script; ///< The mutant
+  std::string functionName;               ///< Name of the mutated function
+  stats::PhaseScope scope;                ///< Where the check time goes
+  CommitFunction commit;                  ///< Called with the result
+  /// The mutated function, if it can be checked in batch
+  std::shared_ptr<const BatchableFunction> batchable;
+  std::string incrementalKey;             ///< Key in the incremental analysis
+  /// Outcome of this mutant, set at its commit, if it can have duplicates
+  std::shared_ptr<CommittedMutant> committed;
+  /// Outcome of the identical mutant, if this is a duplicate
+  std::shared_ptr<const CommittedMutant> duplicateOf;
+  bool passed;                  ///< Result, valid when done is ready
+  std::shared_future<void> done; ///< Completion of the check, once scheduled
+};
+
+/// @brief A future already satisfied
+static std::shared_future<void> readyFuture() {
+  std::promise<void> completed;
+  completed.set_value();
+  return completed.get_future().share();
 }
 
-std::ostream &chimera::MutationTemplate::getReportStream() {
-  return this->reportStream;
+void chimera::MutationTemplate::submitCheck(
+    const CompileCommand &command,
+    std::shared_ptr<const mutant::EditScript> script,
+    const std::string &functionName, const stats::PhaseScope &scope,
+    CommitFunction commit, bool deduplicable,
+    std::shared_ptr<const BatchableFunction> batchable,
+    const std::string &incrementalKey) {
+  std::shared_ptr<PendingCheck> check = std::make_shared<PendingCheck>(
+      command, script, functionName, scope, commit, batchable, incrementalKey);
+  if (deduplicable && this->deduplicateMutants) {
+    // All the scripts are built on the same original source
+    llvm::MD5 hash;
+    hash.update(script->str());
+    llvm::MD5::MD5Result digest;
+    hash.final(digest);
+    llvm::SmallString<32> digestString;
+    llvm::MD5::stringifyResult(digest, digestString);
+
+    auto &committed = this->mutantDigests[digestString.str()];
+    if (committed) {
+      // Identical to a previous mutant, it's committed with it
+      check->duplicateOf = committed;
+      check->done = readyFuture();
+      this->pendingChecks.push_back(check);
+      this->commitChecks_(4 * this->validationJobs);
+      return;
+    }
+    committed = std::make_shared<CommittedMutant>();
+    check->committed = committed;
+  }
+  if (!incrementalKey.empty()) {
+    auto previous = this->previousChecks.find(incrementalKey);
+    if (previous != this->previousChecks.end()) {
+      // Its function hasn't changed since the previous analysis
+      check->passed = previous->second.passed;
+      check->done = readyFuture();
+      ++this->reusedChecks;
+      this->pendingChecks.push_back(check);
+      this->commitChecks_(4 * this->validationJobs);
+      return;
+    }
+  }
+  if (this->checkBatchSize > 1 && batchable) {
+    // A batch gathers mutants of the same function checked with the same
+    // command
+    if (!this->openBatch.empty() &&
+        (this->openBatch.front()->batchable->insertOffset !=
+             batchable->insertOffset ||
+         this->openBatch.front()->command.CommandLine !=
+             command.CommandLine)) {
+      this->flushBatch_();
+    }
+    this->openBatch.push_back(check);
+    this->pendingChecks.push_back(check);
+    if (this->openBatch.size() >= this->checkBatchSize) {
+      this->flushBatch_();
+    }
+  } else {
+    this->flushBatch_();
+    this->scheduleChecks_({check});
+    this->pendingChecks.push_back(check);
+  }
+  // Commit the completed checks, bounding the ones in flight
+  this->commitChecks_(4 * this->validationJobs);
 }
 
-void chimera::MutationTemplate::closeReportStream() {
-  this->reportStream.close();
+void chimera::MutationTemplate::waitChecks() { this->commitChecks_(0); }
+
+/// @brief Commit the completed checks in submission order
+/// @param window Number of pending checks above which the oldest ones are
+///        waited for
+void chimera::MutationTemplate::commitChecks_(size_t window) {
+  while (!this->pendingChecks.empty()) {
+    std::shared_ptr<PendingCheck> check = this->pendingChecks.front();
+    if (!check->done.valid()) {
+      // It belongs to the open batch
+      if (this->pendingChecks.size() <= window) {
+        break;
+      }
+      this->flushBatch_();
+    }
+    if (this->pendingChecks.size() <= window &&
+        check->done.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+      break;
+    }
+    if (check->done.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      ScopedTimer timer(this->getTargetName(), "check wait");
+      check->done.wait();
+    }
+    this->pendingChecks.pop_front();
+    if (check->duplicateOf) {
+      check->commit(check->duplicateOf->passed, check->duplicateOf->id, 0);
+    } else {
+      std::string content;
+      mutant::IdType keptId = 0;
+      if (!check->incrementalKey.empty()) {
+        content = this->getMutantDigest_(*check->script);
+        if (check->passed) {
+          keptId = this->keepMutantId_(check->incrementalKey, content);
+        }
+      }
+      mutant::IdType id = check->commit(check->passed, 0, keptId);
+      if (this->incremental && id != 0) {
+        this->committedIds.insert(id);
+      }
+      if (!check->incrementalKey.empty()) {
+        this->currentChecks[check->incrementalKey] =
+            KeptMutant{check->passed, id, content};
+      }
+      if (check->committed) {
+        check->committed->passed = check->passed;
+        check->committed->id = id;
+      }
+    }
+  }
+}
+
+/// @brief Schedule the checks of the open batch
+void chimera::MutationTemplate::flushBatch_() {
+  if (!this->openBatch.empty()) {
+    this->scheduleChecks_(std::move(this->openBatch));
+    this->openBatch.clear();
+  }
+}
+
+/// @brief Schedule a group of checks, on the pool if there is one or in place
+void chimera::MutationTemplate::scheduleChecks_(
+    std::vector<std::shared_ptr<PendingCheck>> checks) {
+  auto task = [this, checks]() {
+    this->checkBatch_(checks, 0, checks.size());
+  };
+  std::shared_future<void> done;
+  if (this->validationPool) {
+    done = this->validationPool->async(task);
+  } else {
+    ScopedTimer timer(this->getTargetName(), "check wait");
+    task();
+    done = readyFuture();
+  }
+  for (const auto &check : checks) {
+    check->done = done;
+  }
+}
+
+/// @brief Check the mutants [begin, end) of a batch, bisecting it on failure
+/// @details The time of a parse is split evenly among its mutants
+void chimera::MutationTemplate::checkBatch_(
+    const std::vector<std::shared_ptr<PendingCheck>> &checks, size_t begin,
+    size_t end) {
+  if (end - begin == 1) {
+    // Single mutant, check it on the whole source
+    PendingCheck &check = *checks[begin];
+    ScopedTimer timer(this->getTargetName(), check.scope.operatorId,
+                      check.scope.mutatorId, "check");
+    timer.setDetail(check.functionName);
+    std::string code;
+    check.passed =
+        check.script->apply(this->originalSource, code) &&
+        this->checkSyntax(check.command, code, check.functionName) == 0;
+    return;
+  }
+
+  // The original source with the renamed copies after the function
+  unsigned insertOffset = checks[begin]->batchable->insertOffset;
+  std::string batchCode = this->originalSource.substr(0, insertOffset);
+  for (size_t i = begin; i < end; ++i) {
+    const BatchableFunction &function = *checks[i]->batchable;
+    std::string suffix = "__m" + std::to_string(i - begin);
+    size_t nameEnd = function.nameOffset + function.nameLength;
+    batchCode += "\n";
+    batchCode += renameIdentifiers(function.declarations,
+                                   function.declaredNames, suffix);
+    batchCode += renameIdentifiers(function.text.substr(0, nameEnd),
+                                   function.declaredNames, suffix);
+    batchCode += suffix;
+    batchCode += renameIdentifiers(function.text.substr(nameEnd),
+                                   function.declaredNames, suffix);
+  }
+  batchCode += "\n";
+  batchCode += this->originalSource.substr(insertOffset);
+
+  stats::Stopwatch stopwatch;
+  bool passed = this->checkSyntax(checks[begin]->command, batchCode) == 0;
+  stats::StatsRegistry &registry = stats::StatsRegistry::get();
+  stats::TraceRecorder &recorder = stats::TraceRecorder::get();
+  if (registry.isEnabled() || recorder.isEnabled()) {
+    stats::PhaseTime time = stopwatch.elapsed();
+    if (recorder.isEnabled()) {
+      recorder.addSpan(
+          "batch check", stopwatch.getWallStart(), time.wall,
+          {stats::TraceArg("source", this->getTargetName()),
+           stats::TraceArg("detail", checks[begin]->functionName),
+           stats::TraceArg("mutants", std::to_string(end - begin))});
+    }
+    time.wall /= end - begin;
+    time.cpu /= end - begin;
+    if (registry.isEnabled()) {
+      for (size_t i = begin; i < end; ++i) {
+        registry.addTime(this->getTargetName(),
+                         checks[i]->scope.operatorId,
+                         checks[i]->scope.mutatorId, "check", time);
+      }
+    }
+  }
+  if (passed) {
+    for (size_t i = begin; i < end; ++i) {
+      checks[i]->passed = true;
+    }
+    return;
+  }
+  size_t middle = begin + (end - begin) / 2;
+  this->checkBatch_(checks, begin, middle);
+  this->checkBatch_(checks, middle, end);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Report Functions
+bool chimera::MutationTemplate::openReport() {
+  this->reportSinks.clear();
+  for (mutant::ReportFormat format : this->reportFormats) {
+    this->reportSinks.push_back(mutant::ReportSink::createFile(
+        format, this->getTargetOutputDirectory() +
+                    mutant::ReportSink::getFileName(format)));
+    if (format == mutant::CsvReport && this->deduplicateMutants) {
+      // report.csv keeps its columns, the aliases are listed apart
+      this->reportSinks.push_back(mutant::ReportSink::createAliasFile(
+          this->getTargetOutputDirectory() + "aliases.csv"));
+    }
+  }
+  if (!this->reportPipe.empty()) {
+    this->reportSinks.push_back(mutant::ReportSink::createStream(
+        mutant::NdjsonReport, this->reportPipe));
+  }
+  bool opened = true;
+  for (const auto &sink : this->reportSinks) {
+    opened = sink->open() && opened;
+  }
+  if (!opened) {
+    this->reportSinks.clear();
+  }
+  return opened;
+}
+
+void chimera::MutationTemplate::addReportEntry(
+    const mutant::ReportEntry &entry) {
+  for (const auto &sink : this->reportSinks) {
+    sink->write(entry);
+  }
+}
+
+bool chimera::MutationTemplate::closeReport() {
+  bool closed = true;
+  for (const auto &sink : this->reportSinks) {
+    closed = sink->close() && closed;
+  }
+  this->reportSinks.clear();
+  return closed;
 }
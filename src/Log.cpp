@@ -32,7 +32,9 @@ INITIALIZE_EASYLOGGINGPP
 const char* chimera::log::ChimeraLogger::loggerName = "chimeraLogger";  ///< Member initialization
 el::Configurations chimera::log::ChimeraLogger::configurator =
     el::Configurations();
-log::VerboseLevel chimera::log::ChimeraLogger::actualVLevel = 0;
+std::atomic<log::VerboseLevel>
+    chimera::log::ChimeraLogger::actualVLevel(0);
+bool chimera::log::ChimeraLogger::verboseEnabled = false;
 
 void chimera::log::ChimeraLogger::init() {
   /// Configure el++ : chimeraLogger
@@ -68,6 +70,7 @@ void chimera::log::ChimeraLogger::init() {
 }
 
 void chimera::log::ChimeraLogger::initVerbose() {
+  verboseEnabled = true;
   // Verbose Level
   configurator.set(el::Level::Verbose, el::ConfigurationType::Enabled, "true");
   configurator.set(el::Level::Verbose, el::ConfigurationType::ToFile, "false");
@@ -98,8 +101,8 @@ void chimera::log::ChimeraLogger::init(int argc, const char** argv) {
 
 void chimera::log::ChimeraLogger::verbose(VerboseLevel vlevel,
                                           const std::string& msg) {
-  // Check if the logger has been registered
-  if (!isInitialize())
+  // Check if the verbose output is enabled and the logger registered
+  if (!verboseEnabled || !isInitialize())
     return;
   // Check the verbose level
   if (!VLOG_IS_ON(vlevel))
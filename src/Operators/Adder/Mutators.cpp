@@ -132,18 +132,14 @@ bool chimera::adder::MutatorAdder::match(const NodeType &node) {
 
     ////////////////////////////////////////////////////////////////////////////////////////////
     /// Debug
-    char log_string[500];
     Rewriter rw(*(node.SourceManager), node.Context->getLangOpts());
-    ChimeraLogger::verbose("********************************************************\nMatched operation:");
+    CHIMERA_VERBOSE("********************************************************\nMatched operation:");
 
-    sprintf(log_string, "Operation: %s ==> [%s]", rw.getRewrittenText(bop->getSourceRange()).c_str(),bop->getOpcodeStr().str().c_str());
-    ChimeraLogger::verbose(log_string);
+    CHIMERA_VERBOSE("Operation: " + rw.getRewrittenText(bop->getSourceRange()) + " ==> [" + bop->getOpcodeStr().str() + "]");
 
-    sprintf(log_string, "LHS: %s", rw.getRewrittenText(lhs->getSourceRange()).c_str());
-    ChimeraLogger::verbose(log_string);
+    CHIMERA_VERBOSE("LHS: " + rw.getRewrittenText(lhs->getSourceRange()));
 
-    sprintf(log_string, "RHS: %s\n", rw.getRewrittenText(rhs->getSourceRange()).c_str());
-    ChimeraLogger::verbose(log_string);
+    CHIMERA_VERBOSE("RHS: " + rw.getRewrittenText(rhs->getSourceRange()) + "\n");
     //////////////////////////////////////////////////////////////////////////////////////////// 
 
     if(rw.getRewrittenText(lhs->getSourceRange()) == "") return false;
@@ -154,8 +150,6 @@ bool chimera::adder::MutatorAdder::match(const NodeType &node) {
 
 Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType type, Rewriter &rw) {
 
-    char log_info[500];
-
     // Retrieve a pointer to function declaration (or template function declaration) to insert global variables before it
     const FunctionDecl *funDecl = node.Nodes.getNodeAs<FunctionDecl>("functionDecl");
     const FunctionTemplateDecl *templDecl = (FunctionTemplateDecl*)(GET_PARENT_NODE(node, funDecl, FunctionTemplateDecl));
@@ -267,19 +261,15 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
       
     ////////////////////////////////////////////////////////////////////////////////////////////
     /// Debug
-    ChimeraLogger::verbose("********************************************************\nDump binary operation:");
+    CHIMERA_VERBOSE("********************************************************\nDump binary operation:");
 
-    sprintf(log_info, "Operation: %s  ==> [%s]",rw.getRewrittenText(bop->getSourceRange()).c_str(),bop->getOpcodeStr().str().c_str());
-    ChimeraLogger::verbose(log_info);
+    CHIMERA_VERBOSE("Operation: " + rw.getRewrittenText(bop->getSourceRange()) + "  ==> [" + bop->getOpcodeStr().str() + "]");
 
-    sprintf(log_info, "LHS: %s", lhsString.c_str());
-    ChimeraLogger::verbose(log_info);
+    CHIMERA_VERBOSE("LHS: " + lhsString);
 
-    sprintf(log_info, "RHS: %s", rhsString.c_str());
-    ChimeraLogger::verbose(log_info);
+    CHIMERA_VERBOSE("RHS: " + rhsString);
 
-    sprintf(log_info, "Mutation in: %s\n", bopReplacement.c_str());
-    ChimeraLogger::verbose(log_info);
+    CHIMERA_VERBOSE("Mutation in: " + bopReplacement + "\n");
 
     //////////////////////////////////////////////////////////////////////////////////////////// 
 
@@ -288,7 +278,7 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
 
     // Stop if the current node (bop) has no parents
     if( node.Context->getParents(*bop).empty() ) { 
-      ChimeraLogger::verbose("No more parents. Exiting\n");
+      CHIMERA_VERBOSE("No more parents. Exiting\n");
       break; 
     }
 
@@ -297,7 +287,7 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
 
     if(parentType == "BinaryOperator"){
       // If the parent is a BinaryOperator then assign to bop its parent
-      ChimeraLogger::verbose("Parent is a BOP\n");
+      CHIMERA_VERBOSE("Parent is a BOP\n");
       bop = (BinaryOperator*)(GET_PARENT_NODE(node, bop, BinaryOperator));
 
     } else if((parentType == "ParenExpr")){
@@ -307,25 +297,23 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
       while( ( PARENT_NODE_TYPE(node, parens) == "ParenExpr") ){
           parens = (ParenExpr*)(GET_PARENT_NODE(node, parens, ParenExpr));
       }
-      ChimeraLogger::verbose("Parens skipped successfully.\n");
+      CHIMERA_VERBOSE("Parens skipped successfully.\n");
 
       // If the content of parenthesis is not a BinaryOperator then exit else assign
       // parenthesis content to bop
       if( (PARENT_NODE_TYPE(node, parens) != "BinaryOperator") ) {
-        sprintf(log_info, "WARNING: Unexpected parens content of type [%s]. Exiting...\n", PARENT_NODE_TYPE(node, parens).str().c_str());
-        ChimeraLogger::verbose(log_info);
+        CHIMERA_VERBOSE("WARNING: Unexpected parens content of type [" + PARENT_NODE_TYPE(node, parens).str() + "]. Exiting...\n");
         bop = NULL;
       } else bop = (BinaryOperator*)(GET_PARENT_NODE(node, parens, BinaryOperator));
 
     } else if((parentType == "FunDecl") || (parentType == "VarDecl") || (parentType == "ImplicitCastExpr")){
       // If the parent is a FunDecl or a VarDecl then exit
-      ChimeraLogger::verbose("Function o Variable Declaration reached. Exiting...\n");
+      CHIMERA_VERBOSE("Function o Variable Declaration reached. Exiting...\n");
       bop = NULL;
 
     } else {
       // If the parent is not one of the previous IFs, then exit and print the unexpected type
-      sprintf(log_info, "WARNING: Unexpected parent of type [%s]. Exiting...\n", parentType.c_str());
-      ChimeraLogger::verbose(log_info);
+      CHIMERA_VERBOSE("WARNING: Unexpected parent of type [" + parentType + "]. Exiting...\n");
       bop = NULL;
     }
 
@@ -342,8 +330,7 @@ Rewriter &chimera::adder::MutatorAdder::mutate(const NodeType &node, MutatorType
         
       // If a new BinaryOperator has been assigned to bop (indeed bop is not NULL) 
       // and it's a =, then exit 
-      sprintf(log_info, "BOP opcod is [%s]. Exiting...\n", bop->getOpcodeStr().str().c_str());
-      ChimeraLogger::verbose(log_info);
+      CHIMERA_VERBOSE("BOP opcod is [" + bop->getOpcodeStr().str() + "]. Exiting...\n");
       bop = NULL;
     }
 
@@ -364,10 +351,10 @@ void chimera::adder::MutatorAdder::onCreatedMutant(const ::std::string &mDir) {
   ::std::error_code error;
   ::llvm::raw_fd_ostream report(mDir + this->reportName + ".csv", error, ::llvm::sys::fs::OpenFlags::F_Append);
 
-  ChimeraLogger::verbose("****************************************************\nStart writing report");
+  CHIMERA_VERBOSE("****************************************************\nStart writing report");
 
   while( !(this->mutationsInfo.empty()) ){
-    ChimeraLogger::verbose("Writing element...");
+    CHIMERA_VERBOSE("Writing element...");
 
     MutatorAdder::MutationInfo mutationInfo = this->mutationsInfo.back();
     report << mutationInfo.nabId << "," << mutationInfo.line << ","
@@ -378,5 +365,5 @@ void chimera::adder::MutatorAdder::onCreatedMutant(const ::std::string &mDir) {
     this->mutationsInfo.pop_back();
   }
   report.close();
-  ChimeraLogger::verbose("****************************************************\nReport written successfully");
+  CHIMERA_VERBOSE("****************************************************\nReport written successfully");
 }
\ No newline at end of file
@@ -138,9 +138,7 @@ Rewriter &chimera::axdct::MutatorAxDCT::mutate(const NodeType &node, MutatorType
       
     //////////////////////////////////////////////////////////////////////////////////////////
     // Debug
-    char debug_info[500];
-
-    ChimeraLogger::verbose("***************************************************\nDump for loop:");
+    CHIMERA_VERBOSE("***************************************************\nDump for loop:");
 
     // sprintf(debug_info,"Statement: %s", rw.getRewrittenText(forStmt->getSourceRange()).c_str());
     // ChimeraLogger::verbose(debug_info);
@@ -187,24 +185,19 @@ Rewriter &chimera::axdct::MutatorAxDCT::mutate(const NodeType &node, MutatorType
   
     //////////////////////////////////////////////////////////////////////////////////////////
     // Debug
-    ChimeraLogger::verbose("***************************************************\nDump inner for loop:");
+    CHIMERA_VERBOSE("***************************************************\nDump inner for loop:");
 
-    sprintf(debug_info,"Statement: %s", rw.getRewrittenText(forStmt->getSourceRange()).c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE("Statement: " + rw.getRewrittenText(forStmt->getSourceRange()));
     
-    sprintf(debug_info, "Condition: %s", innerCondString.c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE("Condition: " + innerCondString);
 
-    sprintf(debug_info, "Condition Variable: %s", innerCondVariableString.c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE("Condition Variable: " + innerCondVariableString);
 
-    sprintf(debug_info, "Condition Variable: %s", innerCondVariableString.c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE("Condition Variable: " + innerCondVariableString);
 
-    sprintf(debug_info, "Mutate condition in: %s", condReplacement.c_str());
-    ChimeraLogger::verbose(debug_info);
+    CHIMERA_VERBOSE("Mutate condition in: " + condReplacement);
 
-    ChimeraLogger::verbose("****************************************************\n");
+    CHIMERA_VERBOSE("****************************************************\n");
 
     ////////////////////////////////////////////////////////////////////////////////////////// 
 
@@ -222,10 +215,10 @@ void chimera::axdct::MutatorAxDCT::onCreatedMutant(const ::std::string &mDir) {
   ::llvm::raw_fd_ostream report(mDir + "axdct_report.csv", error, ::llvm::sys::fs::OpenFlags::F_Append);
   ::std::vector<MutationInfo> cMutationsInfo = this->mutationsInfo;
 
-  ChimeraLogger::verbose("****************************************************\nStart writing report");
+  CHIMERA_VERBOSE("****************************************************\nStart writing report");
 
   while( !(this->mutationsInfo.empty()) ){
-    ChimeraLogger::verbose("Writing element...");
+    CHIMERA_VERBOSE("Writing element...");
 
     MutatorAxDCT::MutationInfo mutationInfo = this->mutationsInfo.back();
     report << mutationInfo.baseId << "," << mutationInfo.line 
@@ -234,5 +227,5 @@ void chimera::axdct::MutatorAxDCT::onCreatedMutant(const ::std::string &mDir) {
     this->mutationsInfo.pop_back();
   }
   report.close();
-  ChimeraLogger::verbose("****************************************************\nReport written successfully\n");
+  CHIMERA_VERBOSE("****************************************************\nReport written successfully\n");
 }
\ No newline at end of file
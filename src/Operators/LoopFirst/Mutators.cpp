@@ -73,41 +73,42 @@ bool chimera::perforation::MutatorLoopPerforation1::getMatchedNode(
   return true;
 }
 
-/// \brief This method returns the statement matcher to match the binary
-/// operation
+/// \brief This method returns the statement matcher to match a whole for
+///        statement: its initialization (Es. i = 0 or int i = 0), its condition
+///        (Es. i<n) and its increment (Es. i++, i += 1 or i = i + 1) are bound
+///        by the same match, so each loop gives exactly one callback
 ::clang::ast_matchers::StatementMatcher
 chimera::perforation::MutatorLoopPerforation1::getStatementMatcher()
 {
- return stmt(
-            // First consider unsigned int decl
-            // Match the condition statement (Es. i<n)
-            anyOf(binaryOperator(
-                    hasParent(forStmt().bind("for")),
-                    hasLHS(XHS_MATCHER("unsigned int", "lhs"))).bind("binary_cond"),
-                  anything()),
-            // Last consider int decl
-            // Match the condition statement (Es. i<n)
-            anyOf(binaryOperator(
-                    hasParent(forStmt().bind("for")),
-                    hasLHS(XHS_MATCHER("int", "lhs"))).bind("binary_cond"),
-                  anything()),
-
-            // Match case of unary operand (Es. i++)
-            anyOf(unaryOperator(
-                    hasParent(forStmt().bind("for"))).bind("unary_op"),
-                  anything()),
-            // Match case of binary operand (Es. i= i+1)
-            anyOf(binaryOperator(
-                    hasParent(binaryOperator(
-                      hasParent(forStmt().bind("for"))).bind("binary_assign"))).bind("binary_op"),
-                  anything()),
-             // Match case of binary intialization (Es. i = 10)
-             anyOf(binaryOperator(
-                        hasParent(forStmt().bind("for"))).bind("binary_init"),
-                      anything())
-           
-        );
-
+  return forStmt(
+            // Match the initialization, binding its value
+            hasLoopInit(anyOf(
+                binaryOperator(hasOperatorName("="),
+                               hasRHS(expr().bind("init_value"))),
+                declStmt(hasSingleDecl(
+                    varDecl(hasInitializer(expr().bind("init_value"))))))),
+            // Match the condition statement on an int or unsigned int
+            hasCondition(binaryOperator(
+                anyOf(hasLHS(XHS_MATCHER("unsigned int", "lhs")),
+                      hasLHS(XHS_MATCHER("int", "lhs")))).bind("binary_cond")),
+            // Match the increment, unary (Es. i++), compound (Es. i += 1) or
+            // binary (Es. i = i + 1)
+            hasIncrement(anyOf(
+                unaryOperator(anyOf(hasOperatorName("++"),
+                                    hasOperatorName("--"))).bind("unary_op"),
+                binaryOperator(anyOf(hasOperatorName("+="),
+                                     hasOperatorName("-="),
+                                     hasOperatorName("*="),
+                                     hasOperatorName("/="))).bind("binary_op"),
+                binaryOperator(
+                    hasOperatorName("="),
+                    hasRHS(ignoringParenImpCasts(
+                        binaryOperator(anyOf(hasOperatorName("+"),
+                                             hasOperatorName("-"),
+                                             hasOperatorName("*"),
+                                             hasOperatorName("/")))
+                            .bind("binary_op"))))))
+         ).bind("for");
 }
 
 static int  mapOpCode(::clang::BinaryOperator::Opcode code) {
@@ -136,64 +137,18 @@ static int  mapOpCode(::clang::BinaryOperator::Opcode code) {
 }
 
 
-/// \brief This method implements the fine grained matching rules, indeed it is
-///        not possible in an easy way to specify that the node matched it has
-///        not to be part of the condition expression of a for statement
+/// \brief This method implements the fine grained matching rules: only a
+///        loop that counts up or down, by addition or subtraction, can be
+///        perforated replacing its increment
 bool chimera::perforation::MutatorLoopPerforation1::match(
     const ::chimera::mutator::NodeType &node)
 {
-  // First operation: Retrieve the node
-  //const ForStmt *fop = node.Nodes.getNodeAs<ForStmt>("for");
-  const UnaryOperator  *uop   = node.Nodes.getNodeAs<UnaryOperator>("unary_op");
-  const BinaryOperator *bcond = node.Nodes.getNodeAs<BinaryOperator>("binary_cond");
-  const BinaryOperator *bop   = node.Nodes.getNodeAs<BinaryOperator>("binary_op");
-  const BinaryOperator *bas   = node.Nodes.getNodeAs<BinaryOperator>("binary_assign");
-  const BinaryOperator *binit = node.Nodes.getNodeAs<BinaryOperator>("binary_init");
-  const ForStmt        *fst   = node.Nodes.getNodeAs<ForStmt>("for");
- 
-  // Retrive the operator
-  if (uop != nullptr)
-    if(uop->getLocStart() == fst->getInc()->getLocStart()) 
-      this->inc = uop;
-  
-  if (bcond != nullptr){
-    if(bcond->getLocStart() == fst->getCond()->getLocStart())
-      this->cond = bcond;
-    else if(bcond->isCompoundAssignmentOp())
-           if(bcond->getLocStart() == fst->getInc()->getLocStart()){
-             this->binc = bcond;
-             this->bas  = bcond;
-          }
-    else if(bcond->getLocStart() == fst->getInit()->getLocStart())
-           this->init = bcond;   
-  }
-        
-  if (bas != nullptr && bop != nullptr)
-    if(bas->getLocStart() == fst->getInc()->getLocStart()){
-      this->binc = bop; 
-      this->bas  = bas;
-    }
-  
-  // Retrive the binary initializzation
-  if(binit != nullptr)
-    if(binit->getLocStart() == fst->getInit()->getLocStart())
-      this->init = binit;
-
-  // Fine grain condition
-  // Check if both operator are in same forStmt  
-  if (this->inc != nullptr && this->cond != nullptr && this->init != nullptr){
-    if(fst->getInc()->getLocStart() == this->inc->getLocStart() &&
-       fst->getCond()->getLocStart() == this->cond->getLocStart() &&
-       fst->getInit()->getLocStart() == this->init->getLocStart())
-      return true;
-  }else if(this->binc != nullptr && this->bas != nullptr && this->cond != nullptr && this->init != nullptr){
-    if(fst->getInc()->getLocStart() == this->bas->getLocStart() &&
-       fst->getCond()->getLocStart() == this->cond->getLocStart() &&
-       fst->getInit()->getLocStart() == this->init->getLocStart())
-      return true;
+  const BinaryOperator *bop = node.Nodes.getNodeAs<BinaryOperator>("binary_op");
+  if (bop != nullptr) {
+    int code = mapOpCode(bop->getOpcode());
+    return code == 1 || code == 2;
   }
-  // If operator are from different forStmt return false
-  return false;
+  return true;
 }
 
 ::clang::Rewriter &chimera::perforation::MutatorLoopPerforation1::mutate(
@@ -206,10 +161,16 @@ bool chimera::perforation::MutatorLoopPerforation1::match(
   // As first operation always retrieve the node
   const ForStmt *fst = node.Nodes.getNodeAs<ForStmt>("for");
   const FunctionDecl *funDecl = node.Nodes.getNodeAs<FunctionDecl>("functionDecl");
+  const BinaryOperator *cond = node.Nodes.getNodeAs<BinaryOperator>("binary_cond");
+  const UnaryOperator  *uop  = node.Nodes.getNodeAs<UnaryOperator>("unary_op");
+  const BinaryOperator *bop  = node.Nodes.getNodeAs<BinaryOperator>("binary_op");
+  const Expr *initValue = node.Nodes.getNodeAs<Expr>("init_value");
   const clang::ASTContext * ctx = node.Context;
   // Assert a precondition
   assert(fst      != nullptr && "getNodeAs returned a nullptr");
   assert(funDecl  != nullptr && "getNodeAs returned a nullptr");
+  assert(cond     != nullptr && "getNodeAs returned a nullptr");
+  assert(initValue != nullptr && "getNodeAs returned a nullptr");
  
   // Insert global variable
   this->opId++; 
@@ -217,12 +178,12 @@ bool chimera::perforation::MutatorLoopPerforation1::match(
                       "int stride" + to_string(this->opId) + " = 1;\n");
 
   // Retrive left operator from condition
-  std::string lhs = rw.getRewrittenText(this->cond->getLHS()->getSourceRange());
+  std::string lhs = rw.getRewrittenText(cond->getLHS()->getSourceRange());
 
   // Prepare replacemente string
   std::string incReplacement = "";
-  if(this->binc){
-    switch (mapOpCode(this->binc->getOpcode())){
+  if(bop){
+    switch (mapOpCode(bop->getOpcode())){
       case 1:
         incReplacement = lhs + " = " + lhs + " + stride" + to_string(this->opId);
       break;
@@ -231,14 +192,14 @@ bool chimera::perforation::MutatorLoopPerforation1::match(
         inc = false;
       break;
       default :
-        ChimeraLogger::verbose("OpCode sconosciuto: " + std::to_string(this->binc->getOpcode())); 
+        CHIMERA_VERBOSE("OpCode sconosciuto: " + std::to_string(bop->getOpcode())); 
       break;
     } 
   }else{
-    if(this->inc){
-      if(this->inc->isIncrementOp()) 
+    if(uop){
+      if(uop->isIncrementOp()) 
         incReplacement = lhs + " = " + lhs + " + stride" + to_string(this->opId);
-      else if(this->inc->isDecrementOp()){ 
+      else if(uop->isDecrementOp()){ 
         inc = false;
         incReplacement = lhs + " = " + lhs + " - stride" + to_string(this->opId);
       }
@@ -261,9 +222,9 @@ bool chimera::perforation::MutatorLoopPerforation1::match(
   llvm::APSInt condRHSIval,initRHSIval;
 
   // Retrive right operator from condition
-  clang::Expr* condRHS = this->cond->getRHS();
-  // Retrive right operator from initialization 
-  clang::Expr* initRHS = this->init->getRHS();
+  const clang::Expr* condRHS = cond->getRHS();
+  // Retrive the initialization value
+  const clang::Expr* initRHS = initValue;
   
   if(initRHS->isEvaluatable(*(ctx)) && condRHS->isEvaluatable(*(ctx))){
     if(initRHS->EvaluateAsInt(initRHSIval,*(ctx))){}
@@ -297,17 +258,10 @@ bool chimera::perforation::MutatorLoopPerforation1::match(
   this->mutationsInfo.push_back(mutationInfo);
 
   DEBUG(::llvm::dbgs() << rw.getRewrittenText(fst->getSourceRange()) << "\n");
-  clean(); 
   // Return Rewriter and close functions
   return rw;
 }
 
-void ::chimera::perforation::MutatorLoopPerforation1::clean()
-{
-  this->cond = this->binc = this->bas = nullptr;
-  this->inc = nullptr;
-}
-
 void ::chimera::perforation::MutatorLoopPerforation1::onCreatedMutant(
     const ::std::string &mDir) {
   // Create a specific report inside the mutant directory
@@ -69,113 +69,52 @@ bool chimera::perforation::MutatorLoopPerforation2::getMatchedNode(
   return true;
 }
 
-/// \brief This method returns the statement matcher to match the binary
-/// operation
+/// \brief This method returns the statement matcher to match a whole for
+///        statement: its initialization (Es. i = 0 or int i = 0), its condition
+///        (Es. i<n) and its increment (Es. i++, i += 1 or i = i + 1) are bound
+///        by the same match, so each loop gives exactly one callback
 ::clang::ast_matchers::StatementMatcher
 chimera::perforation::MutatorLoopPerforation2::getStatementMatcher()
 {
- return stmt(
-            // First consider unsigned int decl
-            // Match the condition statement (Es. i<n)
-            anyOf(binaryOperator(
-                    hasParent(forStmt().bind("for")),
-                    hasLHS(XHS_MATCHER("unsigned int", "lhs"))).bind("binary_cond"),
-                  anything()),
-            // Last consider int decl
-            // Match the condition statement (Es. i<n)
-            anyOf(binaryOperator(
-                    hasParent(forStmt().bind("for")),
-                    hasLHS(XHS_MATCHER("int", "lhs"))).bind("binary_cond"),
-                  anything()),
-            // Match case of binary intialization (Es. i = 10)
-            anyOf(binaryOperator(
-                    hasParent(forStmt().bind("for"))).bind("binary_init"),
-                  anything()),
-  
-            // Match case of unary operand (Es. i++)
-            anyOf(unaryOperator(
-                    hasParent(forStmt().bind("for"))).bind("unary_op"),
-                  anything()),
-            // Match case of binary operand (Es. i= i+1)
-            anyOf(binaryOperator(
-                    hasParent(binaryOperator(
-                      hasParent(forStmt().bind("for"))).bind("binary_assign"))).bind("binary_op"),
-                  anything())           
-        );
-
+  return forStmt(
+            // Match the initialization, binding its value
+            hasLoopInit(anyOf(
+                binaryOperator(hasOperatorName("="),
+                               hasRHS(expr().bind("init_value"))),
+                declStmt(hasSingleDecl(
+                    varDecl(hasInitializer(expr().bind("init_value"))))))),
+            // Match the condition statement on an int or unsigned int
+            hasCondition(binaryOperator(
+                anyOf(hasLHS(XHS_MATCHER("unsigned int", "lhs")),
+                      hasLHS(XHS_MATCHER("int", "lhs")))).bind("binary_cond")),
+            // Match the increment, unary (Es. i++), compound (Es. i += 1) or
+            // binary (Es. i = i + 1)
+            hasIncrement(anyOf(
+                unaryOperator(anyOf(hasOperatorName("++"),
+                                    hasOperatorName("--"))).bind("unary_op"),
+                binaryOperator(anyOf(hasOperatorName("+="),
+                                     hasOperatorName("-="),
+                                     hasOperatorName("*="),
+                                     hasOperatorName("/="))).bind("binary_op"),
+                binaryOperator(
+                    hasOperatorName("="),
+                    hasRHS(ignoringParenImpCasts(
+                        binaryOperator(anyOf(hasOperatorName("+"),
+                                             hasOperatorName("-"),
+                                             hasOperatorName("*"),
+                                             hasOperatorName("/")))
+                            .bind("binary_op"))))))
+         ).bind("for");
 }
 
-/// \brief This method implements the fine grained matching rules, indeed it is
-///        not possible in an easy way to specify that the node matched it has
-///        not to be part of the condition expression of a for statement
+/// \brief The coarse grain is enough: the iterations are skipped in the
+///        body, whatever the increment is
 bool chimera::perforation::MutatorLoopPerforation2::match(
     const ::chimera::mutator::NodeType &node)
 {
-  // First operation: Retrieve the node
-  const BinaryOperator *bcond = node.Nodes.getNodeAs<BinaryOperator>("binary_cond");
-  const UnaryOperator  *uop   = node.Nodes.getNodeAs<UnaryOperator>("unary_op");
-  const BinaryOperator *binit = node.Nodes.getNodeAs<BinaryOperator>("binary_init");
-  const BinaryOperator *bop   = node.Nodes.getNodeAs<BinaryOperator>("binary_op");
-  const BinaryOperator *bas   = node.Nodes.getNodeAs<BinaryOperator>("binary_assign");
-  const ForStmt        *fst   = node.Nodes.getNodeAs<ForStmt>("for");
-
-  // Retrive the binary operator 
-  if (uop != nullptr)
-    if(uop->getLocStart() == fst->getInc()->getLocStart()) 
-      this->inc = uop;
-  
-  // Retrive the binary condition
-  if (bcond != nullptr){
-    if(bcond->getLocStart() == fst->getCond()->getLocStart()){ this->cond = bcond;
-    }// If binary Operator corrispond to Initialization, retrive init. 
-    if(bcond->getLocStart() == fst->getInit()->getLocStart()){ this->init = bcond; 
-    }  
-  }
-
-  if (bcond != nullptr){
-    if(bcond->getLocStart() == fst->getCond()->getLocStart()) this->cond = bcond;
-    else
-      if(bcond->isCompoundAssignmentOp())
-        if(bcond->getLocStart() == fst->getInc()->getLocStart()){
-          this->binc = bcond;
-          this->bas  = bcond;
-        }
-  }
- 
-  if (bas != nullptr && bop != nullptr)
-    if(bas->getLocStart() == fst->getInc()->getLocStart()){
-      this->binc = bop; 
-      this->bas  = bas;
-    }
-
-  // Retrive the binary condition  
-  if (bcond != nullptr)
-    if(bcond->getLocStart() == fst->getCond()->getLocStart()) this->cond = bcond;
-
-  // Retrive the binary initializzation
-  if(binit != nullptr)
-    if(binit->getLocStart() == fst->getInit()->getLocStart())
-      this->init = binit;
-  
-  // Fine grain condition
-  // Check if both operator are in same forStmt  
-  if (this->inc != nullptr && this->init != nullptr && this->cond != nullptr){
-    if(fst->getInc()->getLocStart()  == this->inc->getLocStart() &&
-       fst->getInit()->getLocStart() == this->init->getLocStart() &&
-       fst->getCond()->getLocStart() == this->cond->getLocStart())
-      return true;
-  }
-  if (this->binc != nullptr && this->bas != nullptr && this->init != nullptr && this->cond != nullptr){
-    if(fst->getInc()->getLocStart()  == this->bas->getLocStart() &&
-       fst->getInit()->getLocStart() == this->init->getLocStart() &&
-       fst->getCond()->getLocStart() == this->cond->getLocStart())
-      return true;
-  }
-  // If operator are from different forStmt return false
-  return false;
+  return true;
 }
 
-
 static int  mapOpCode(::clang::BinaryOperator::Opcode code) {
   int  retString;
   switch (code) {
@@ -212,10 +151,16 @@ static int  mapOpCode(::clang::BinaryOperator::Opcode code) {
   // As first operation always retrieve the node
   const ForStmt *fst = node.Nodes.getNodeAs<ForStmt>("for");
   const FunctionDecl *funDecl = node.Nodes.getNodeAs<FunctionDecl>("functionDecl");
+  const BinaryOperator *cond = node.Nodes.getNodeAs<BinaryOperator>("binary_cond");
+  const UnaryOperator  *uop  = node.Nodes.getNodeAs<UnaryOperator>("unary_op");
+  const BinaryOperator *bop  = node.Nodes.getNodeAs<BinaryOperator>("binary_op");
+  const Expr *initValue = node.Nodes.getNodeAs<Expr>("init_value");
   const clang::ASTContext * ctx = node.Context;
   // Assert a precondition
   assert(fst      != nullptr && "getNodeAs returned a nullptr");
   assert(funDecl  != nullptr && "getNodeAs returned a nullptr");
+  assert(cond     != nullptr && "getNodeAs returned a nullptr");
+  assert(initValue != nullptr && "getNodeAs returned a nullptr");
   
   // Insert global variable
   this->opId++; 
@@ -226,7 +171,7 @@ static int  mapOpCode(::clang::BinaryOperator::Opcode code) {
                       "stride" + to_string(this->opId) + " = 1;\n");
 
   // Retrive left operator from condition
-  std::string lhs = rw.getRewrittenText(this->cond->getLHS()->getSourceRange());
+  std::string lhs = rw.getRewrittenText(cond->getLHS()->getSourceRange());
   // Declare Replacement String
   std::string replacement = "if ( " + lhs + " \% stride" + to_string(this->opId) + " != 0) {";
   // Insert replacement
@@ -234,10 +179,10 @@ static int  mapOpCode(::clang::BinaryOperator::Opcode code) {
   rw.InsertTextAfterToken(fst->getBody()->getLocEnd(),";}"); 
   //check if is increasing or decreasing for
   
-  if(this->binc){
-    int r =  mapOpCode(this->binc->getOpcode());  
+  if(bop){
+    int r =  mapOpCode(bop->getOpcode());  
     if(r == 2) inc = false;
-  }else if(this->inc && this->inc->isDecrementOp())
+  }else if(uop && uop->isDecrementOp())
                inc = false;
 
   //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -257,9 +202,9 @@ static int  mapOpCode(::clang::BinaryOperator::Opcode code) {
   llvm::APSInt condRHSIval,initRHSIval;
 
   // Retrive right operator from condition
-  clang::Expr* condRHS = this->cond->getRHS();
-  // Retrive right operator from initialization 
-  clang::Expr* initRHS = this->init->getRHS();
+  const clang::Expr* condRHS = cond->getRHS();
+  // Retrive the initialization value
+  const clang::Expr* initRHS = initValue;
   
   if(initRHS->isEvaluatable(*(ctx)) && condRHS->isEvaluatable(*(ctx))){
     if(initRHS->EvaluateAsInt(initRHSIval,*(ctx))){}
@@ -293,8 +238,6 @@ static int  mapOpCode(::clang::BinaryOperator::Opcode code) {
   this->mutationsInfo.push_back(mutationInfo);
 
   DEBUG(::llvm::dbgs() << rw.getRewrittenText(fst->getSourceRange()) << "\n");
-
-  this->cond = this->init = nullptr;
   // Return Rewriter and close functions
   return rw;
 }
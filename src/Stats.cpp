@@ -0,0 +1,445 @@
+//===- Stats.cpp ------------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file Stats.cpp
+/// \author Federico Iannucci
+/// \brief This file implements the instrumentation of the chimera phases
+//===----------------------------------------------------------------------===//
+
+#include "Stats.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+
+#include <ctime>
+#include <tuple>
+
+#ifdef LLVM_ON_UNIX
+#include <unistd.h>
+#endif
+
+using namespace chimera::stats;
+
+/// @brief CPU seconds spent by the calling thread
+static double threadCpuSeconds() {
+#if defined(LLVM_ON_UNIX) && defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec now;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0) {
+    return now.tv_sec + now.tv_nsec / 1e9;
+  }
+#endif
+  // Process CPU time, it includes the other threads
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+/// @brief Write a CSV field between double quotes, doubling the quotes in it
+static void writeCsvString(llvm::StringRef value, llvm::raw_ostream &out) {
+  out << '"';
+  for (char c : value) {
+    if (c == '"') {
+      out << '"';
+    }
+    out << c;
+  }
+  out << '"';
+}
+
+/// @brief Write a JSON string
+static void writeJsonString(llvm::StringRef value, llvm::raw_ostream &out) {
+  out << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out << "\\u00";
+      out.write_hex(static_cast<unsigned char>(c) >> 4);
+      out.write_hex(c & 0xf);
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+/// @brief Write the phases as a JSON object
+static void writePhases(const std::map<std::string, PhaseTime> &phases,
+                        llvm::raw_ostream &out) {
+  out << "{";
+  bool first = true;
+  for (const auto &phase : phases) {
+    out << (first ? "" : ",");
+    first = false;
+    writeJsonString(phase.first, out);
+    out << ":{\"wall\":" << llvm::format("%.6f", phase.second.wall)
+        << ",\"cpu\":" << llvm::format("%.6f", phase.second.cpu)
+        << ",\"count\":" << phase.second.count << "}";
+  }
+  out << "}";
+}
+
+chimera::stats::Stopwatch::Stopwatch()
+    : wallStart(std::chrono::steady_clock::now()),
+      cpuStart(threadCpuSeconds()) {}
+
+PhaseTime chimera::stats::Stopwatch::elapsed() const {
+  PhaseTime time;
+  time.wall = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            this->wallStart)
+                  .count();
+  time.cpu = threadCpuSeconds() - this->cpuStart;
+  time.count = 1;
+  return time;
+}
+
+StatsRegistry &chimera::stats::StatsRegistry::get() {
+  static StatsRegistry registry;
+  return registry;
+}
+
+void chimera::stats::StatsRegistry::clear() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->sources.clear();
+  this->counters.clear();
+}
+
+PhaseTime
+chimera::stats::StatsRegistry::getPhaseTime(const std::string &source,
+                                            const std::string &phase) const {
+  PhaseTime total;
+  auto add = [&total](const PhaseMap &phases, const std::string &phase) {
+    auto time = phases.find(phase);
+    if (time != phases.end()) {
+      total.wall += time->second.wall;
+      total.cpu += time->second.cpu;
+      total.count += time->second.count;
+    }
+  };
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto sourceStats = this->sources.find(source);
+  if (sourceStats != this->sources.end()) {
+    add(sourceStats->second.phases, phase);
+    for (const auto &op : sourceStats->second.operators) {
+      for (const auto &mutator : op.second) {
+        add(mutator.second, phase);
+      }
+    }
+  }
+  return total;
+}
+
+MatcherCounters
+chimera::stats::StatsRegistry::getCounters(const std::string &source) const {
+  MatcherCounters total;
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto sourceCounters = this->counters.find(source);
+  if (sourceCounters != this->counters.end()) {
+    for (const auto &op : sourceCounters->second) {
+      for (const auto &mutator : op.second) {
+        for (int i = 0; i < MatcherCounterCount; ++i) {
+          total.values[i] += mutator.second.values[i];
+        }
+      }
+    }
+  }
+  return total;
+}
+
+void chimera::stats::StatsRegistry::writeCounters(
+    llvm::raw_ostream &out) const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  for (const auto &source : this->counters) {
+    for (const auto &op : source.second) {
+      for (const auto &mutator : op.second) {
+        writeCsvString(source.first, out);
+        out << "," << op.first << "," << mutator.first;
+        for (uint64_t value : mutator.second.values) {
+          out << "," << value;
+        }
+        out << "\n";
+      }
+    }
+  }
+}
+
+bool chimera::stats::StatsRegistry::readCounters(llvm::StringRef csv) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  bool valid = true;
+  while (!csv.empty()) {
+    llvm::StringRef line;
+    std::tie(line, csv) = csv.split('\n');
+    if (line.empty()) {
+      continue;
+    }
+    // The values from the end, the quoted source file name can contain
+    // commas
+    uint64_t values[MatcherCounterCount];
+    bool lineValid = true;
+    for (int i = MatcherCounterCount - 1; i >= 0 && lineValid; --i) {
+      llvm::StringRef value;
+      std::tie(line, value) = line.rsplit(',');
+      lineValid = !value.getAsInteger(10, values[i]);
+    }
+    llvm::StringRef source, operatorId, mutatorId;
+    std::tie(line, mutatorId) = line.rsplit(',');
+    std::tie(source, operatorId) = line.rsplit(',');
+    if (!lineValid || source.size() < 2 || !source.startswith("\"") ||
+        !source.endswith("\"") || operatorId.empty()) {
+      valid = false;
+      continue;
+    }
+    // The quoted source, with its quotes doubled
+    std::string sourceName;
+    source = source.drop_front().drop_back();
+    for (size_t i = 0; i < source.size(); ++i) {
+      sourceName += source[i];
+      if (source[i] == '"' && i + 1 < source.size() && source[i + 1] == '"') {
+        ++i;
+      }
+    }
+    MatcherCounters &total =
+        this->counters[sourceName][operatorId.str()][mutatorId.str()];
+    for (int i = 0; i < MatcherCounterCount; ++i) {
+      total.values[i] += values[i];
+    }
+  }
+  return valid;
+}
+
+void chimera::stats::StatsRegistry::printCounters(
+    llvm::raw_ostream &out) const {
+  // Sum on the sources
+  std::map<std::pair<std::string, std::string>, MatcherCounters> totals;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (const auto &source : this->counters) {
+      for (const auto &op : source.second) {
+        for (const auto &mutator : op.second) {
+          MatcherCounters &total =
+              totals[std::make_pair(op.first, mutator.first)];
+          for (int i = 0; i < MatcherCounterCount; ++i) {
+            total.values[i] += mutator.second.values[i];
+          }
+        }
+      }
+    }
+  }
+  out << "Operator/Mutator                          Callbacks       Fine"
+         "  Fine%      Edits     Passed     Failed Duplicates\n";
+  for (const auto &total : totals) {
+    const uint64_t *values = total.second.values;
+    double fineRatio =
+        values[CallbackCounter] == 0
+            ? 0
+            : 100.0 * values[FineMatchCounter] / values[CallbackCounter];
+    out << llvm::format(
+        "%-40s %10llu %10llu %5.1f%% %10llu %10llu %10llu %10llu\n",
+        (total.first.first + "/" + total.first.second).c_str(),
+        static_cast<unsigned long long>(values[CallbackCounter]),
+        static_cast<unsigned long long>(values[FineMatchCounter]), fineRatio,
+        static_cast<unsigned long long>(values[EditCounter]),
+        static_cast<unsigned long long>(values[PassedCounter]),
+        static_cast<unsigned long long>(values[FailedCounter]),
+        static_cast<unsigned long long>(values[DuplicateCounter]));
+  }
+}
+
+void chimera::stats::StatsRegistry::addTime(const std::string &source,
+                                            const std::string &operatorId,
+                                            const std::string &mutatorId,
+                                            const std::string &phase,
+                                            const PhaseTime &time) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  SourceStats &sourceStats = this->sources[source];
+  PhaseTime &total =
+      operatorId.empty() && mutatorId.empty()
+          ? sourceStats.phases[phase]
+          : sourceStats.operators[operatorId][mutatorId][phase];
+  total.wall += time.wall;
+  total.cpu += time.cpu;
+  total.count += time.count;
+}
+
+bool chimera::stats::StatsRegistry::writeSources(llvm::raw_ostream &out) const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  bool firstSource = true;
+  for (const auto &source : this->sources) {
+    out << (firstSource ? "" : ",");
+    firstSource = false;
+    writeJsonString(source.first, out);
+    out << ":{\"phases\":";
+    writePhases(source.second.phases, out);
+    out << ",\"operators\":{";
+    bool firstOperator = true;
+    for (const auto &op : source.second.operators) {
+      out << (firstOperator ? "" : ",");
+      firstOperator = false;
+      writeJsonString(op.first, out);
+      out << ":{\"mutators\":{";
+      bool firstMutator = true;
+      for (const auto &mutator : op.second) {
+        out << (firstMutator ? "" : ",");
+        firstMutator = false;
+        writeJsonString(mutator.first, out);
+        out << ":";
+        writePhases(mutator.second, out);
+      }
+      out << "}}";
+    }
+    out << "}}";
+  }
+  return !firstSource;
+}
+
+bool chimera::stats::StatsRegistry::writeReport(
+    const std::string &path, const std::vector<std::string> &fragments) const {
+  std::error_code fileError;
+  llvm::raw_fd_ostream out(path, fileError, llvm::sys::fs::F_Text);
+  if (fileError) {
+    return false;
+  }
+  out << "{\"sources\":{";
+  bool written = this->writeSources(out);
+  for (const auto &fragment : fragments) {
+    if (!fragment.empty()) {
+      out << (written ? "," : "") << fragment;
+      written = true;
+    }
+  }
+  out << "}}\n";
+  out.close();
+  if (out.has_error()) {
+    out.clear_error();
+    return false;
+  }
+  return true;
+}
+
+chimera::stats::TraceRecorder::TraceRecorder()
+    : enabled(false), mainThread(std::this_thread::get_id()) {
+#ifdef LLVM_ON_UNIX
+  this->processId = ::getpid();
+#else
+  this->processId = 0;
+#endif
+}
+
+void chimera::stats::TraceRecorder::clear() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->events.clear();
+  this->threads.clear();
+  this->mainThread = std::this_thread::get_id();
+#ifdef LLVM_ON_UNIX
+  this->processId = ::getpid();
+#endif
+}
+
+TraceRecorder &chimera::stats::TraceRecorder::get() {
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+void chimera::stats::TraceRecorder::setEnabled(bool val) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->mainThread = std::this_thread::get_id();
+  this->enabled.store(val);
+}
+
+unsigned chimera::stats::TraceRecorder::getThreadNumber_() {
+  auto thread =
+      this->threads
+          .insert(std::make_pair(std::this_thread::get_id(),
+                                 static_cast<unsigned>(this->threads.size())))
+          .first;
+  return thread->second;
+}
+
+void chimera::stats::TraceRecorder::addSpan(
+    const char *name, std::chrono::steady_clock::time_point start, double wall,
+    const std::vector<TraceArg> &args) {
+  uint64_t startMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+                             start.time_since_epoch())
+                             .count();
+  std::string event;
+  llvm::raw_string_ostream out(event);
+  out << "{\"name\":";
+  writeJsonString(name, out);
+  out << ",\"cat\":\"chimera\",\"ph\":\"X\",\"ts\":" << startMicros
+      << ",\"dur\":" << static_cast<uint64_t>(wall * 1e6) << ",\"args\":{";
+  for (size_t i = 0; i < args.size(); ++i) {
+    out << (i == 0 ? "" : ",");
+    writeJsonString(args[i].first, out);
+    out << ":";
+    writeJsonString(args[i].second, out);
+  }
+  out << "}";
+  out.flush();
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->events += this->events.empty() ? "" : ",";
+  this->events += event;
+  this->events += ",\"pid\":" + std::to_string(this->processId) +
+                  ",\"tid\":" + std::to_string(this->getThreadNumber_()) +
+                  "}";
+}
+
+bool chimera::stats::TraceRecorder::writeEvents(llvm::raw_ostream &out) const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->events.empty()) {
+    return false;
+  }
+  out << this->events;
+  // Name the threads
+  for (const auto &thread : this->threads) {
+    out << ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"
+        << this->processId << ",\"tid\":" << thread.second
+        << ",\"args\":{\"name\":\""
+        << (thread.first == this->mainThread
+                ? std::string("main")
+                : "worker " + std::to_string(thread.second))
+        << "\"}}";
+  }
+  return true;
+}
+
+bool chimera::stats::TraceRecorder::writeTrace(
+    const std::string &path, const std::vector<std::string> &fragments) const {
+  std::error_code fileError;
+  llvm::raw_fd_ostream out(path, fileError, llvm::sys::fs::F_Text);
+  if (fileError) {
+    return false;
+  }
+  out << "{\"traceEvents\":[";
+  bool written = this->writeEvents(out);
+  for (const auto &fragment : fragments) {
+    if (!fragment.empty()) {
+      out << (written ? "," : "") << fragment;
+      written = true;
+    }
+  }
+  out << "],\"displayTimeUnit\":\"ms\"}\n";
+  out.close();
+  if (out.has_error()) {
+    out.clear_error();
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,189 @@
+//===- ASTCacheTest.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ASTCacheTest.cpp
+/// \author Federico Iannucci
+/// \brief Tests of the mutants generated on the ASTs of the cache
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutationTemplate.h"
+#include "Operators/Examples/Operators.h"
+#include "Testing/ChimeraTest.h"
+#include "Tooling/ASTCache.h"
+#include "Utils.h"
+
+#include "clang/Frontend/ASTUnit.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace chimera;
+
+/// @brief The source mutated by the tests
+static const char *cacheTestSource =
+    "int max(int a, int b) {\n"
+    "  if (a > b) {\n"
+    "    return a;\n"
+    "  }\n"
+    "  return b;\n"
+    "}\n"
+    "int count(const int *v, int n, int t) {\n"
+    "  int c = 0;\n"
+    "  for (int i = 0; i < n; i++) {\n"
+    "    if (v[i] > t) {\n"
+    "      c++;\n"
+    "    }\n"
+    "  }\n"
+    "  return c;\n"
+    "}\n";
+
+/// @brief Fixture with the source and the cache in a temporary directory
+class ASTCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ::llvm::SmallString<256> directory;
+    ASSERT_FALSE(::llvm::sys::fs::createUniqueDirectory("chimera-ast-cache",
+                                                        directory));
+    this->directory = directory.str().str() + fs::pathSep;
+    this->sourcePath = this->directory + "source.cpp";
+    std::error_code error;
+    ::llvm::raw_fd_ostream source(this->sourcePath, error,
+                                  ::llvm::sys::fs::F_Text);
+    ASSERT_FALSE(error) << "Couldn't write " << this->sourcePath;
+    source << cacheTestSource;
+    source.close();
+
+    this->command.Directory = this->directory;
+    this->command.CommandLine = {"clang++", "-std=c++11", this->sourcePath,
+                                 "-w", "-fsyntax-only"};
+    this->cache = std::make_shared<ASTCache>(this->directory + "cache");
+  }
+
+  void TearDown() override {
+    ::llvm::sys::fs::remove_directories(this->directory);
+  }
+
+  /// @brief Mutate the source with the ROR operator, using the cache
+  /// @return The files of the mutants and of the report, by relative path
+  std::map<std::string, std::string> mutate(const std::string &outputName) {
+    std::string outputDirectory = this->directory + outputName;
+    m_operator::MutationOperatorPtr op = examples::getROROperator();
+    MutationTemplate t(this->command, this->sourcePath, outputDirectory);
+    t.loadOperator(op.get());
+    t.setGenerateMutants(true);
+    t.setMutantStoreMode(mutant::FullMutantStore);
+    t.setGenerateMutantsReport(true);
+    t.setASTCache(this->cache);
+    t.analyze();
+
+    std::map<std::string, std::string> files;
+    std::error_code error;
+    for (::llvm::sys::fs::recursive_directory_iterator it(outputDirectory,
+                                                          error),
+         end;
+         !error && it != end; it.increment(error)) {
+      if (!::llvm::sys::fs::is_regular_file(it->path())) {
+        continue;
+      }
+      auto buffer = ::llvm::MemoryBuffer::getFile(it->path());
+      EXPECT_TRUE(static_cast<bool>(buffer)) << "Couldn't read "
+                                             << it->path();
+      if (buffer) {
+        files[it->path().substr(outputDirectory.size())] =
+            (*buffer)->getBuffer().str();
+      }
+    }
+    EXPECT_FALSE(error) << "Couldn't list " << outputDirectory;
+    return files;
+  }
+
+  std::string directory;  ///< Temporary directory, with trailing pathSep
+  std::string sourcePath; ///< The mutated source
+  ::clang::tooling::CompileCommand command;
+  std::shared_ptr<ASTCache> cache;
+};
+
+TEST_F(ASTCacheTest, HitGivesTheMutantsOfAMiss) {
+  // The first analysis parses the source and saves its AST
+  std::map<std::string, std::string> missFiles = this->mutate("miss");
+  bool cached = false;
+  EXPECT_TRUE(this->cache->getAST(this->command, this->sourcePath, cached) !=
+              nullptr);
+  ASSERT_TRUE(cached) << "The AST of the first analysis hasn't been saved";
+
+  // The second one loads it
+  std::map<std::string, std::string> hitFiles = this->mutate("hit");
+  ASSERT_FALSE(missFiles.empty()) << "No mutant has been generated";
+  EXPECT_EQ(missFiles, hitFiles);
+}
+
+TEST_F(ASTCacheTest, HeaderCreatedOnTheSearchPathInvalidates) {
+  // source.cpp includes inc/config.h through -I
+  std::string includeDir = this->directory + "inc";
+  ASSERT_FALSE(::llvm::sys::fs::create_directory(includeDir));
+  std::error_code error;
+  {
+    ::llvm::raw_fd_ostream header(includeDir + fs::pathSep + "config.h",
+                                  error, ::llvm::sys::fs::F_Text);
+    ASSERT_FALSE(error) << "Couldn't write config.h";
+    header << "#define LIMIT 1\n";
+  }
+  {
+    ::llvm::raw_fd_ostream source(this->sourcePath, error,
+                                  ::llvm::sys::fs::F_Text);
+    ASSERT_FALSE(error) << "Couldn't write " << this->sourcePath;
+    source << "#include \"config.h\"\n"
+              "bool over(int a) { return a > LIMIT; }\n";
+  }
+  this->command.CommandLine.push_back("-I" + includeDir);
+
+  bool cached = true;
+  EXPECT_TRUE(this->cache->getAST(this->command, this->sourcePath, cached) !=
+              nullptr);
+  EXPECT_FALSE(cached);
+  EXPECT_TRUE(this->cache->getAST(this->command, this->sourcePath, cached) !=
+              nullptr);
+  EXPECT_TRUE(cached);
+
+  // A config.h beside the source is found first by the quoted include
+  {
+    ::llvm::raw_fd_ostream header(this->directory + "config.h", error,
+                                  ::llvm::sys::fs::F_Text);
+    ASSERT_FALSE(error) << "Couldn't write config.h";
+    header << "#define LIMIT 2\n";
+  }
+  EXPECT_TRUE(this->cache->getAST(this->command, this->sourcePath, cached) !=
+              nullptr);
+  EXPECT_FALSE(cached);
+}
+
+TEST_F(ASTCacheTest, PruneRemovesTheEntriesAboveTheSize) {
+  this->mutate("first");
+  this->cache->prune(1, 0);
+  bool cached = true;
+  EXPECT_TRUE(this->cache->getAST(this->command, this->sourcePath, cached) !=
+              nullptr);
+  EXPECT_FALSE(cached);
+}
@@ -0,0 +1,155 @@
+//===- BatchCheckTest.cpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file BatchCheckTest.cpp
+/// \author Federico Iannucci
+/// \brief Tests of the mutants checked in batch
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutationTemplate.h"
+#include "Operators/LoopFirst/Operator.h"
+#include "Stats.h"
+#include "Testing/ChimeraTest.h"
+#include "Utils.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <string>
+
+using namespace chimera;
+
+/// @brief A function with four perforable loops: the loop perforation
+///        mutants insert a stride global before it at each loop
+static const char *batchTestSource =
+    "void perforate(int n) {\n"
+    "  int a[16];\n"
+    "  for (int i = 0; i < 16; i++) {\n"
+    "    a[i] = i;\n"
+    "  }\n"
+    "  int j;\n"
+    "  for (j = 0; j < n; j = j + 2) {\n"
+    "    a[j] = 0;\n"
+    "  }\n"
+    "  for (j = 15; j > 0; j = j - 1) {\n"
+    "    a[j] = a[j - 1];\n"
+    "  }\n"
+    "  for (unsigned k = 0; k < 16; k += 4) {\n"
+    "    a[k] = 1;\n"
+    "  }\n"
+    "}\n";
+
+/// @brief Fixture with the source in a temporary directory
+class BatchCheckTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ::llvm::SmallString<256> directory;
+    ASSERT_FALSE(::llvm::sys::fs::createUniqueDirectory("chimera-batch",
+                                                        directory));
+    this->directory = directory.str().str() + fs::pathSep;
+    this->sourcePath = this->directory + "source.cpp";
+    std::error_code error;
+    ::llvm::raw_fd_ostream source(this->sourcePath, error,
+                                  ::llvm::sys::fs::F_Text);
+    ASSERT_FALSE(error) << "Couldn't write " << this->sourcePath;
+    source << batchTestSource;
+    source.close();
+
+    this->command.Directory = this->directory;
+    this->command.CommandLine = {"clang++", "-std=c++11", this->sourcePath,
+                                 "-w", "-fsyntax-only"};
+  }
+
+  void TearDown() override {
+    ::llvm::sys::fs::remove_directories(this->directory);
+  }
+
+  /// @brief Mutate the source with the loop perforation operator
+  /// @param batchSize The maximum number of mutants checked in a parse
+  /// @return The files of the mutants and of the report, by relative path
+  std::map<std::string, std::string> mutate(unsigned batchSize) {
+    std::string outputDirectory =
+        this->directory + "batch" + std::to_string(batchSize);
+    m_operator::MutationOperatorPtr op =
+        perforation::getPerforationFirstOperator();
+    MutationTemplate t(this->command, this->sourcePath, outputDirectory);
+    t.loadOperator(op.get());
+    t.setGenerateMutants(true);
+    t.setMutantStoreMode(mutant::FullMutantStore);
+    t.setGenerateMutantsReport(true);
+    t.setCheckBatchSize(batchSize);
+    t.analyze();
+
+    std::map<std::string, std::string> files;
+    std::error_code error;
+    for (::llvm::sys::fs::recursive_directory_iterator it(outputDirectory,
+                                                          error),
+         end;
+         !error && it != end; it.increment(error)) {
+      if (!::llvm::sys::fs::is_regular_file(it->path())) {
+        continue;
+      }
+      auto buffer = ::llvm::MemoryBuffer::getFile(it->path());
+      EXPECT_TRUE(static_cast<bool>(buffer)) << "Couldn't read "
+                                             << it->path();
+      if (buffer) {
+        files[it->path().substr(outputDirectory.size())] =
+            (*buffer)->getBuffer().str();
+      }
+    }
+    EXPECT_FALSE(error) << "Couldn't list " << outputDirectory;
+    return files;
+  }
+
+  std::string directory;  ///< Temporary directory, with trailing pathSep
+  std::string sourcePath; ///< The mutated source
+  ::clang::tooling::CompileCommand command;
+};
+
+TEST_F(BatchCheckTest, InsertedDeclarationsAreBatched) {
+  std::map<std::string, std::string> single = this->mutate(1);
+  ASSERT_FALSE(single.empty()) << "No mutant has been generated";
+
+  // The first version of the HOM mutant is checked alone, the next three
+  // in a single parse that has to pass with their strides renamed
+  stats::TraceRecorder &recorder = stats::TraceRecorder::get();
+  recorder.setEnabled(true);
+  recorder.clear();
+  std::map<std::string, std::string> batched = this->mutate(4);
+  std::string events;
+  ::llvm::raw_string_ostream out(events);
+  recorder.writeEvents(out);
+  out.flush();
+  recorder.setEnabled(false);
+  recorder.clear();
+
+  EXPECT_EQ(single, batched);
+  size_t batches = 0;
+  const char *batchSpan = "\"batch check\"";
+  for (size_t found = events.find(batchSpan); found != std::string::npos;
+       found = events.find(batchSpan, found + 1)) {
+    ++batches;
+  }
+  EXPECT_EQ(1u, batches) << "The batch has been split: " << events;
+}
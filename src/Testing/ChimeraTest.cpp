@@ -194,12 +194,22 @@ void chimera::testing::testMutatorMatch(chimera::mutator::Mutator *mutator) {
         // Create a MatchCallback
         MatchFinder::MatchCallback *callback =
             new MutatorMatchingTestCallback(mutationOutputStream, m);
+        // As the MutationTemplate does, the enclosing function definition is
+        // bound to "functionDecl"
         switch (m.getMatcherType()) {
         case StatementMatcherType:
-          finder.addMatcher(m.getStatementMatcher(), callback);
+          finder.addMatcher(
+              stmt(m.getStatementMatcher(),
+                   hasAncestor(functionDecl(isDefinition())
+                                   .bind("functionDecl"))),
+              callback);
           break;
         case DeclarationMatcherType:
-          finder.addMatcher(m.getDeclarationMatcher(), callback);
+          finder.addMatcher(
+              decl(m.getDeclarationMatcher(),
+                   hasAncestor(functionDecl(isDefinition())
+                                   .bind("functionDecl"))),
+              callback);
           break;
         case TypeMatcherType:
           finder.addMatcher(m.getTypeMatcher(), callback);
@@ -0,0 +1,85 @@
+//===- EditScriptTest.cpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file EditScriptTest.cpp
+/// \author Federico Iannucci
+/// \brief Unit tests of the edit scripts of the mutants
+//===----------------------------------------------------------------------===//
+
+#include "Core/EditScript.h"
+#include "Testing/ChimeraTest.h"
+
+#include <string>
+
+using chimera::mutant::EditScript;
+
+/// @brief Two functions, as mutated by the operators
+static const char *editTestSource = "int a;\n"
+                                    "int f(int x) {\n"
+                                    "  int y = x + 1;\n"
+                                    "  return y;\n"
+                                    "}\n"
+                                    "int g() {\n"
+                                    "  return 2;\n"
+                                    "}\n";
+
+TEST(EditScriptTest, IdenticalSourcesHaveNoEdit) {
+  EXPECT_TRUE(EditScript::diff(editTestSource, editTestSource).empty());
+}
+
+TEST(EditScriptTest, DiffHasAnEditPerChange) {
+  std::string mutated = editTestSource;
+  // A global inserted before f, as the operators do, and two body changes
+  mutated.replace(mutated.find("return 2"), 8, "return 3");
+  mutated.replace(mutated.find("x + 1"), 5, "x - 1");
+  mutated.insert(mutated.find("int f"), "int stride1 = 1;\n");
+
+  EditScript script = EditScript::diff(editTestSource, mutated);
+  ASSERT_EQ(3u, script.getEdits().size());
+  EXPECT_EQ(std::string(editTestSource).find("int f"),
+            script.getEdits()[0].offset);
+  EXPECT_EQ(0u, script.getEdits()[0].length);
+  EXPECT_EQ("int stride1 = 1;\n", script.getEdits()[0].replacement);
+  EXPECT_EQ(1u, script.getEdits()[1].length);
+  EXPECT_EQ("-", script.getEdits()[1].replacement);
+  EXPECT_EQ(1u, script.getEdits()[2].length);
+  EXPECT_EQ("3", script.getEdits()[2].replacement);
+
+  std::string applied;
+  ASSERT_TRUE(script.apply(editTestSource, applied));
+  EXPECT_EQ(mutated, applied);
+}
+
+TEST(EditScriptTest, DiffOfRemovedAndAddedLines) {
+  std::string mutated = editTestSource;
+  mutated.erase(mutated.find("  int y"), 15);
+  mutated += "int h() { return 0; }";
+
+  EditScript script = EditScript::diff(editTestSource, mutated);
+  EXPECT_EQ(2u, script.getEdits().size());
+  std::string applied;
+  ASSERT_TRUE(script.apply(editTestSource, applied));
+  EXPECT_EQ(mutated, applied);
+
+  // The serialized script reads back the same edits
+  EditScript read;
+  ASSERT_TRUE(EditScript::read(script.str(), read));
+  EXPECT_EQ(script.str(), read.str());
+}
@@ -0,0 +1,192 @@
+//===- FunctionFilterTest.cpp ---------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file FunctionFilterTest.cpp
+/// \author Federico Iannucci
+/// \brief Unit tests of the function selection of the FunOp configuration
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutationTemplate.h"
+#include "Testing/ChimeraTest.h"
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+
+#include <memory>
+#include <string>
+
+using namespace clang;
+using namespace clang::ast_matchers;
+using chimera::FunctionFilter;
+
+/// @brief The functions the filters are tried on
+static const char *filterSource = "void fir_kernel() {}\n"
+                                  "namespace dsp {\n"
+                                  "void fir_kernel() {}\n"
+                                  "void iir_kernel() {}\n"
+                                  "namespace detail {\n"
+                                  "void fir_kernel() {}\n"
+                                  "}\n"
+                                  "struct Filter {\n"
+                                  "  void apply() {}\n"
+                                  "};\n"
+                                  "}\n";
+
+/// @brief Fixture parsing filterSource once per test
+class FunctionFilterTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    this->unit = tooling::buildASTFromCode(filterSource);
+    ASSERT_TRUE(this->unit != nullptr) << "Couldn't parse the test source";
+  }
+
+  /// @brief If the filter selects the function with that qualified name
+  bool selects(const FunctionFilter &filter,
+               const std::string &qualifiedName) {
+    auto functions = match(functionDecl(isDefinition()).bind("function"),
+                           this->unit->getASTContext());
+    for (const BoundNodes &nodes : functions) {
+      const FunctionDecl *function =
+          nodes.getNodeAs<FunctionDecl>("function");
+      if (function->getQualifiedNameAsString() == qualifiedName) {
+        return filter.selects(*function);
+      }
+    }
+    ADD_FAILURE() << qualifiedName << " isn't in the test source";
+    return false;
+  }
+
+  std::unique_ptr<ASTUnit> unit;
+};
+
+TEST_F(FunctionFilterTest, EmptySelectsNothing) {
+  FunctionFilter filter;
+  EXPECT_FALSE(this->selects(filter, "fir_kernel"));
+  EXPECT_FALSE(this->selects(filter, "dsp::Filter::apply"));
+}
+
+TEST_F(FunctionFilterTest, SelectAll) {
+  FunctionFilter filter;
+  filter.selectAll();
+  EXPECT_TRUE(filter.isAll());
+  EXPECT_TRUE(this->selects(filter, "fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::detail::fir_kernel"));
+}
+
+TEST_F(FunctionFilterTest, UnqualifiedNameInAnyScope) {
+  FunctionFilter filter;
+  EXPECT_TRUE(filter.add("fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::detail::fir_kernel"));
+  EXPECT_FALSE(this->selects(filter, "dsp::iir_kernel"));
+}
+
+TEST_F(FunctionFilterTest, QualifiedNameMatchesTheLastScopes) {
+  FunctionFilter filter;
+  EXPECT_TRUE(filter.add("detail::fir_kernel"));
+  EXPECT_TRUE(filter.add("Filter::apply"));
+  EXPECT_TRUE(this->selects(filter, "dsp::detail::fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::Filter::apply"));
+  EXPECT_FALSE(this->selects(filter, "fir_kernel"));
+  EXPECT_FALSE(this->selects(filter, "dsp::fir_kernel"));
+
+  // A suffix is made of whole scopes
+  FunctionFilter partial;
+  EXPECT_TRUE(partial.add("tail::fir_kernel"));
+  EXPECT_FALSE(this->selects(partial, "dsp::detail::fir_kernel"));
+}
+
+TEST_F(FunctionFilterTest, FullyQualifiedName) {
+  FunctionFilter filter;
+  EXPECT_TRUE(filter.add("::fir_kernel"));
+  EXPECT_TRUE(filter.add("::dsp::fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::fir_kernel"));
+  EXPECT_FALSE(this->selects(filter, "dsp::detail::fir_kernel"));
+}
+
+TEST_F(FunctionFilterTest, UnqualifiedGlobOnTheName) {
+  FunctionFilter filter;
+  EXPECT_TRUE(filter.add("*_kernel"));
+  EXPECT_TRUE(filter.add("app?y"));
+  EXPECT_TRUE(this->selects(filter, "fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::iir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::Filter::apply"));
+
+  // The glob matches the whole name
+  FunctionFilter prefix;
+  EXPECT_TRUE(prefix.add("fir*"));
+  EXPECT_TRUE(this->selects(prefix, "dsp::fir_kernel"));
+  EXPECT_FALSE(this->selects(prefix, "dsp::iir_kernel"));
+}
+
+TEST_F(FunctionFilterTest, QualifiedGlobOnTheQualifiedName) {
+  FunctionFilter filter;
+  EXPECT_TRUE(filter.add("::dsp::*_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::detail::fir_kernel"));
+  EXPECT_FALSE(this->selects(filter, "fir_kernel"));
+  EXPECT_FALSE(this->selects(filter, "dsp::Filter::apply"));
+
+  // The regex characters of a glob are literal
+  FunctionFilter literal;
+  EXPECT_TRUE(literal.add("dsp::fir.kernel*"));
+  EXPECT_FALSE(this->selects(literal, "dsp::fir_kernel"));
+}
+
+TEST_F(FunctionFilterTest, RegexOnTheQualifiedName) {
+  FunctionFilter filter;
+  EXPECT_TRUE(filter.add("re:dsp::(detail::)?fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::fir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::detail::fir_kernel"));
+  EXPECT_FALSE(this->selects(filter, "fir_kernel"));
+
+  // The regex is anchored
+  FunctionFilter anchored;
+  EXPECT_TRUE(anchored.add("re:fir_.*"));
+  EXPECT_TRUE(this->selects(anchored, "fir_kernel"));
+  EXPECT_FALSE(this->selects(anchored, "dsp::fir_kernel"));
+}
+
+TEST_F(FunctionFilterTest, MalformedRegexSelectsNothing) {
+  FunctionFilter filter;
+  EXPECT_FALSE(filter.add("re:fir_(kernel"));
+  EXPECT_FALSE(filter.add("re:[a-"));
+  EXPECT_FALSE(this->selects(filter, "fir_kernel"));
+  EXPECT_FALSE(this->selects(filter, "dsp::fir_kernel"));
+
+  // The valid entries are still used
+  EXPECT_TRUE(filter.add("iir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::iir_kernel"));
+  EXPECT_FALSE(this->selects(filter, "dsp::fir_kernel"));
+}
+
+TEST_F(FunctionFilterTest, Merge) {
+  FunctionFilter filter;
+  FunctionFilter other;
+  EXPECT_TRUE(filter.add("iir_kernel"));
+  EXPECT_TRUE(other.add("re:dsp::Filter::.*"));
+  filter.merge(other);
+  EXPECT_TRUE(this->selects(filter, "dsp::iir_kernel"));
+  EXPECT_TRUE(this->selects(filter, "dsp::Filter::apply"));
+  EXPECT_FALSE(this->selects(filter, "dsp::fir_kernel"));
+}
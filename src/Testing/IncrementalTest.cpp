@@ -0,0 +1,184 @@
+//===- IncrementalTest.cpp ------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file IncrementalTest.cpp
+/// \author Federico Iannucci
+/// \brief Tests of the mutants kept by the incremental analysis
+//===----------------------------------------------------------------------===//
+
+#include "Core/MutationTemplate.h"
+#include "Operators/Examples/Operators.h"
+#include "Testing/ChimeraTest.h"
+#include "Utils.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <set>
+#include <string>
+
+using namespace chimera;
+
+/// @brief The source mutated by the tests, count is changed between the
+///        analyses
+static const char *incrementalTestSource =
+    "int max(int a, int b) {\n"
+    "  if (a > b) {\n"
+    "    return a;\n"
+    "  }\n"
+    "  return b;\n"
+    "}\n"
+    "int count(const int *v, int n, int t) {\n"
+    "  int c = 0;\n"
+    "  for (int i = 0; i < n; i++) {\n"
+    "    if (v[i] > t) {\n"
+    "      c++;\n"
+    "    }\n"
+    "  }\n"
+    "  return c;\n"
+    "}\n";
+
+/// @brief Fixture with the source and the outputs in a temporary directory
+class IncrementalTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ::llvm::SmallString<256> directory;
+    ASSERT_FALSE(::llvm::sys::fs::createUniqueDirectory("chimera-incremental",
+                                                        directory));
+    this->directory = directory.str().str() + fs::pathSep;
+    this->sourcePath = this->directory + "source.cpp";
+    this->writeSource(incrementalTestSource);
+
+    this->command.Directory = this->directory;
+    this->command.CommandLine = {"clang++", "-std=c++11", this->sourcePath,
+                                 "-w", "-fsyntax-only"};
+  }
+
+  void TearDown() override {
+    ::llvm::sys::fs::remove_directories(this->directory);
+  }
+
+  void writeSource(const std::string &code) {
+    std::error_code error;
+    ::llvm::raw_fd_ostream source(this->sourcePath, error,
+                                  ::llvm::sys::fs::F_Text);
+    ASSERT_FALSE(error) << "Couldn't write " << this->sourcePath;
+    source << code;
+  }
+
+  /// @brief Mutate the source with the ROR operator, incrementally
+  /// @return The ids of the mutants in the report, by function
+  std::map<std::string, std::set<mutant::IdType>> mutate() {
+    m_operator::MutationOperatorPtr op = examples::getROROperator();
+    MutationTemplate t(this->command, this->sourcePath,
+                       this->directory + "output");
+    t.loadOperator(op.get());
+    t.setGenerateMutants(true);
+    t.setMutantStoreMode(mutant::FullMutantStore);
+    t.setGenerateMutantsReport(true);
+    t.setIncremental(true);
+    t.analyze();
+    this->outputDirectory = t.getTargetOutputDirectory();
+
+    // Each row is: id,function,line,column,mutator,type
+    std::map<std::string, std::set<mutant::IdType>> ids;
+    auto report = ::llvm::MemoryBuffer::getFile(this->outputDirectory +
+                                                "report.csv");
+    EXPECT_TRUE(static_cast<bool>(report)) << "Couldn't read the report";
+    if (!report) {
+      return ids;
+    }
+    ::llvm::SmallVector<::llvm::StringRef, 64> rows;
+    (*report)->getBuffer().split(rows, '\n', -1, false);
+    for (::llvm::StringRef row : rows) {
+      ::llvm::SmallVector<::llvm::StringRef, 6> fields;
+      row.split(fields, ',');
+      mutant::IdType id;
+      if (fields.size() == 6 && !fields[0].getAsInteger(10, id)) {
+        ids[fields[1].str()].insert(id);
+      }
+    }
+    return ids;
+  }
+
+  /// @brief Path of a mutant in the full store
+  std::string getMutantPath(mutant::IdType id) {
+    return this->outputDirectory + std::to_string(id) + fs::pathSep +
+           "source.cpp";
+  }
+
+  std::string directory;       ///< Temporary directory, with trailing pathSep
+  std::string sourcePath;      ///< The mutated source
+  std::string outputDirectory; ///< Output directory of the source
+  ::clang::tooling::CompileCommand command;
+};
+
+TEST_F(IncrementalTest, UnchangedFunctionKeepsItsMutants) {
+  std::map<std::string, std::set<mutant::IdType>> first = this->mutate();
+  ASSERT_FALSE(first["max"].empty()) << "No mutant of max";
+  ASSERT_FALSE(first["count"].empty()) << "No mutant of count";
+
+  // A mutant that isn't written again keeps the marker
+  std::string keptPath = this->getMutantPath(*first["max"].begin());
+  {
+    std::error_code error;
+    ::llvm::raw_fd_ostream kept(keptPath, error, ::llvm::sys::fs::F_Append);
+    ASSERT_FALSE(error) << "Couldn't write " << keptPath;
+    kept << "// kept\n";
+  }
+
+  // Only the body of count changes
+  std::string changed = incrementalTestSource;
+  changed.replace(changed.find("c++;"), 4, "c += 1;");
+  this->writeSource(changed);
+  std::map<std::string, std::set<mutant::IdType>> second = this->mutate();
+
+  EXPECT_EQ(first["max"], second["max"]);
+  auto kept = ::llvm::MemoryBuffer::getFile(keptPath);
+  ASSERT_TRUE(static_cast<bool>(kept)) << "Couldn't read " << keptPath;
+  EXPECT_TRUE((*kept)->getBuffer().endswith("// kept\n"));
+
+  // The mutants of count are new, the old ones are removed
+  ASSERT_EQ(first["count"].size(), second["count"].size());
+  for (mutant::IdType id : second["count"]) {
+    EXPECT_GT(id, *first["count"].rbegin());
+  }
+  for (mutant::IdType id : first["count"]) {
+    EXPECT_FALSE(::llvm::sys::fs::exists(this->getMutantPath(id)));
+  }
+}
+
+TEST_F(IncrementalTest, DeclarationChangeInvalidatesAllFunctions) {
+  std::map<std::string, std::set<mutant::IdType>> first = this->mutate();
+  ASSERT_FALSE(first["max"].empty()) << "No mutant of max";
+
+  // A declaration out of the bodies can change any function
+  this->writeSource(std::string("#define LIMIT 1\n") + incrementalTestSource);
+  std::map<std::string, std::set<mutant::IdType>> second = this->mutate();
+  ASSERT_EQ(first["max"].size(), second["max"].size());
+  for (mutant::IdType id : second["max"]) {
+    EXPECT_EQ(0u, first["max"].count(id));
+  }
+}
@@ -0,0 +1,437 @@
+//===- ASTCache.cpp ---------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file ASTCache.cpp
+/// \author Federico Iannucci
+/// \brief  This file implements the on-disk cache of the serialized ASTs
+//===----------------------------------------------------------------------===//
+
+#include "Log.h"
+#include "Utils.h"
+#include "Tooling/ASTCache.h"
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "clang/Lex/DirectoryLookup.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <ctime>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <sys/stat.h>
+#include <utime.h>
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace chimera::log;
+
+/// Anchor used to locate the clang resources relative to the executable
+static int resourcesAnchor;
+
+/// @brief Length of an MD5 digest as hexadecimal string
+static const size_t digestLength = 32;
+/// @brief Digest of a file that has to stay absent
+static const char absentDigest[] = "--------------------------------";
+static_assert(sizeof(absentDigest) == digestLength + 1,
+              "absentDigest has to be as long as a digest");
+/// @brief Seconds after which an entry without .deps is a failed save
+static const time_t incompleteEntryAge = 3600;
+
+/// @brief MD5 of a file content, as hexadecimal string
+/// @return If the file could be read
+static bool digestFile(const ::std::string& path, ::std::string& digest) {
+  auto buffer = ::llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    return false;
+  }
+  ::llvm::MD5 hash;
+  hash.update((*buffer)->getBuffer());
+  ::llvm::MD5::MD5Result result;
+  hash.final(result);
+  ::llvm::SmallString<32> digestString;
+  ::llvm::MD5::stringifyResult(result, digestString);
+  digest = digestString.str();
+  return true;
+}
+
+/// @brief The paths an include lookup tried before finding its file
+/// @details A header created in one of them would be included instead. The
+///          lookups are rebuilt from the search path: a file under a search
+///          directory has been missed in the directories before it, and in
+///          the directory of the main file, where the quoted includes are
+///          looked up first. The directories of the including headers aren't
+///          considered.
+static ::std::set<::std::string> getMissedIncludes(ASTUnit& unit) {
+  const SourceManager& sourceManager = unit.getSourceManager();
+  const FileManager& fileManager = unit.getFileManager();
+  // Absolute, without the trailing separators of the -I paths
+  auto absolute = [&fileManager](::llvm::StringRef path) {
+    ::llvm::SmallString<256> absolutePath(path);
+    fileManager.makeAbsolutePath(absolutePath);
+    ::std::string result = absolutePath.str().str();
+    while (result.size() > 1 && result.back() == ::chimera::fs::pathSep) {
+      result.pop_back();
+    }
+    return result;
+  };
+
+  ::std::vector<::std::string> searchDirs;
+  const FileEntry* mainFile =
+      sourceManager.getFileEntryForID(sourceManager.getMainFileID());
+  ::std::string mainDir;
+  if (mainFile != nullptr) {
+    mainDir = absolute(mainFile->getDir()->getName());
+  }
+  HeaderSearch& headerSearch = unit.getPreprocessor().getHeaderSearchInfo();
+  for (auto it = headerSearch.search_dir_begin();
+       it != headerSearch.search_dir_end(); ++it) {
+    if (it->isNormalDir()) {
+      searchDirs.push_back(absolute(it->getDir()->getName()));
+    }
+  }
+
+  ::std::set<::std::string> missed;
+  for (auto it = sourceManager.fileinfo_begin();
+       it != sourceManager.fileinfo_end(); ++it) {
+    if (it->first == mainFile) {
+      continue;
+    }
+    ::std::string path = absolute(it->first->getName());
+    for (size_t i = 0; i < searchDirs.size(); ++i) {
+      const ::std::string& dir = searchDirs[i];
+      if (path.size() <= dir.size() + 1 ||
+          path.compare(0, dir.size(), dir) != 0 ||
+          path[dir.size()] != ::chimera::fs::pathSep) {
+        continue;
+      }
+      ::std::string relative = path.substr(dir.size() + 1);
+      if (!mainDir.empty() && mainDir != dir) {
+        missed.insert(mainDir + ::chimera::fs::pathSep + relative);
+      }
+      for (size_t j = 0; j < i; ++j) {
+        missed.insert(searchDirs[j] + ::chimera::fs::pathSep + relative);
+      }
+      break;
+    }
+  }
+  return missed;
+}
+
+chimera::ASTCache::ASTCache(const ::std::string& directory)
+    : directory(directory),
+      pchContainerOps(::std::make_shared<PCHContainerOperations>()) {
+  if (this->directory.empty() ||
+      this->directory.back() != ::chimera::fs::pathSep) {
+    this->directory += ::chimera::fs::pathSep;
+  }
+  ::chimera::fs::createDirectories(this->directory);
+}
+
+chimera::ASTCache::~ASTCache() {
+}
+
+::std::unique_ptr<ASTUnit> chimera::ASTCache::getAST(
+    const CompileCommand& command, const ::std::string& sourceFilePath,
+    bool& cached) {
+  cached = false;
+  auto source = ::llvm::MemoryBuffer::getFile(sourceFilePath);
+  if (!source) {
+    ChimeraLogger::warning("Couldn't read " + sourceFilePath);
+    return nullptr;
+  }
+
+  // The key: what the AST depends on, but the included files
+  ::llvm::MD5 hash;
+  ::llvm::StringRef separator("\0", 1);
+  hash.update(getClangFullVersion());
+  hash.update(separator);
+  hash.update(command.Directory);
+  for (const auto& argument : command.CommandLine) {
+    hash.update(separator);
+    hash.update(argument);
+  }
+  hash.update(separator);
+  hash.update(sourceFilePath);
+  hash.update(separator);
+  hash.update((*source)->getBuffer());
+  ::llvm::MD5::MD5Result result;
+  hash.final(result);
+  ::llvm::SmallString<32> key;
+  ::llvm::MD5::stringifyResult(result, key);
+  ::std::string entryPath = this->directory + key.str().str();
+
+  ::std::unique_ptr<ASTUnit> unit = this->load_(entryPath);
+  if (unit) {
+    ChimeraLogger::verbose("Loaded the AST of " + sourceFilePath +
+                           " from the cache");
+    // The modification time of .deps is the last use of the entry
+    ::utime((entryPath + ".deps").c_str(), nullptr);
+    cached = true;
+    return unit;
+  }
+  unit = this->parse_(command, sourceFilePath);
+  if (unit && !unit->getDiagnostics().hasErrorOccurred()) {
+    if (this->save_(*unit, entryPath)) {
+      ChimeraLogger::verbose("Saved the AST of " + sourceFilePath +
+                             " in the cache");
+    } else {
+      ChimeraLogger::warning("Couldn't save the AST of " + sourceFilePath +
+                             " in the cache");
+    }
+  }
+  return unit;
+}
+
+::std::unique_ptr<ASTUnit> chimera::ASTCache::load_(
+    const ::std::string& entryPath) {
+  auto deps = ::llvm::MemoryBuffer::getFile(entryPath + ".deps");
+  if (!deps) {
+    return nullptr;
+  }
+  // Each line is: <MD5> <path>, or <absentDigest> <path>
+  ::llvm::SmallVector<::llvm::StringRef, 64> lines;
+  (*deps)->getBuffer().split(lines, '\n', -1, false);
+  for (::llvm::StringRef line : lines) {
+    if (line.size() <= digestLength + 1) {
+      ChimeraLogger::verbose("Malformed AST cache entry " + entryPath);
+      return nullptr;
+    }
+    ::std::string path = line.substr(digestLength + 1).str();
+    if (line.substr(0, digestLength) == absentDigest) {
+      if (::llvm::sys::fs::exists(path)) {
+        ChimeraLogger::verbose("Stale AST cache entry, " + path +
+                               " has been created");
+        return nullptr;
+      }
+      continue;
+    }
+    ::std::string digest;
+    if (!digestFile(path, digest) || line.substr(0, digestLength) != digest) {
+      ChimeraLogger::verbose("Stale AST cache entry, " + path +
+                             " has changed");
+      return nullptr;
+    }
+  }
+
+  IntrusiveRefCntPtr<DiagnosticsEngine> diagnostics =
+      CompilerInstance::createDiagnostics(new DiagnosticOptions());
+  return ASTUnit::LoadFromASTFile(entryPath + ".ast",
+                                  this->pchContainerOps->getRawReader(),
+                                  diagnostics, FileSystemOptions());
+}
+
+::std::unique_ptr<ASTUnit> chimera::ASTCache::parse_(
+    const CompileCommand& command, const ::std::string& sourceFilePath) {
+  // Arguments as the driver would receive them, the relative paths of the
+  // command are resolved in its directory as the ClangTool does
+  ::std::vector<::std::string> arguments = command.CommandLine;
+  arguments.push_back("-working-directory");
+  arguments.push_back(command.Directory);
+  ::std::vector<const char*> argv;
+  for (const auto& argument : arguments) {
+    argv.push_back(argument.c_str());
+  }
+
+  IntrusiveRefCntPtr<DiagnosticsEngine> diagnostics =
+      CompilerInstance::createDiagnostics(new DiagnosticOptions());
+  ::std::string resourcesPath = CompilerInvocation::GetResourcesPath(
+      argv[0], static_cast<void*>(&resourcesAnchor));
+
+  ::std::unique_ptr<ASTUnit> unit(ASTUnit::LoadFromCommandLine(
+      argv.data(), argv.data() + argv.size(), this->pchContainerOps,
+      diagnostics, resourcesPath, /* OnlyLocalDecls */ false,
+      /* CaptureDiagnostics */ false, /* RemappedFiles */ None,
+      /* RemappedFilesKeepOriginalName */ true,
+      /* PrecompilePreamble */ false, TU_Complete,
+      /* CacheCodeCompletionResults */ false,
+      /* IncludeBriefCommentsInCodeCompletion */ false,
+      /* AllowPCHWithCompilerErrors */ false,
+      /* SkipFunctionBodies */ false, /* UserFilesAreVolatile */ false,
+      /* ForSerialization */ true));
+  if (!unit) {
+    ChimeraLogger::warning("Couldn't load the translation unit of " +
+                           sourceFilePath);
+  }
+  return unit;
+}
+
+bool chimera::ASTCache::digestFiles(const SourceManager& sourceManager,
+                                     bool withMainFile, ::std::string& deps) {
+  const FileManager& fileManager = sourceManager.getFileManager();
+  const FileEntry* mainFile =
+      sourceManager.getFileEntryForID(sourceManager.getMainFileID());
+  // Sorted, the source manager keeps the files in a hash table
+  ::std::set<::std::string> lines;
+  for (auto it = sourceManager.fileinfo_begin();
+       it != sourceManager.fileinfo_end(); ++it) {
+    if (!withMainFile && it->first == mainFile) {
+      continue;
+    }
+    ::llvm::SmallString<256> path(it->first->getName());
+    fileManager.makeAbsolutePath(path);
+    ::std::string digest;
+    if (!digestFile(path.str().str(), digest)) {
+      return false;
+    }
+    lines.insert(digest + " " + path.str().str() + "\n");
+  }
+  for (const auto& line : lines) {
+    deps += line;
+  }
+  return true;
+}
+
+bool chimera::ASTCache::save_(ASTUnit& unit, const ::std::string& entryPath) {
+  // The files read by the parse, the main file included
+  ::std::string deps;
+  if (!digestFiles(unit.getSourceManager(), true, deps)) {
+    return false;
+  }
+  for (const auto& path : getMissedIncludes(unit)) {
+    deps += ::std::string(absentDigest) + " " + path + "\n";
+  }
+
+  // ASTUnit::Save renames a temporary file, true means failure
+  if (unit.Save(entryPath + ".ast")) {
+    return false;
+  }
+  // The entry becomes valid when its .deps appears
+  int fd;
+  ::llvm::SmallString<256> tempPath;
+  if (::llvm::sys::fs::createUniqueFile(entryPath + "-%%%%%%%%.deps", fd,
+                                        tempPath)) {
+    return false;
+  }
+  {
+    ::llvm::raw_fd_ostream file(fd, /* shouldClose */ true);
+    file << deps;
+    file.close();
+    if (file.has_error()) {
+      file.clear_error();
+      ::llvm::sys::fs::remove(tempPath);
+      return false;
+    }
+  }
+  if (::llvm::sys::fs::rename(tempPath, entryPath + ".deps")) {
+    ::llvm::sys::fs::remove(tempPath);
+    return false;
+  }
+  return true;
+}
+
+void chimera::ASTCache::prune(uint64_t maxSize, uint64_t maxAge) {
+  // The files of an entry start with its key: <key>.ast, <key>.deps and the
+  // temporaries of their saves
+  struct Entry {
+    Entry() : size(0), used(0), complete(false) {}
+
+    uint64_t size;                       ///< Bytes of its files
+    time_t used;                         ///< Last use, or save
+    bool complete;                       ///< If it has a .deps
+    ::std::vector<::std::string> files;  ///< Its files, .deps first
+  };
+  ::std::map<::std::string, Entry> entries;
+  ::std::error_code error;
+  for (::llvm::sys::fs::directory_iterator it(this->directory, error), end;
+       !error && it != end; it.increment(error)) {
+    ::std::string path = it->path();
+    ::llvm::StringRef name = ::llvm::sys::path::filename(path);
+    struct stat status;
+    if (name.size() <= digestLength ||
+        name.substr(0, digestLength).find_first_not_of("0123456789abcdef") !=
+            ::llvm::StringRef::npos ||
+        ::stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode)) {
+      continue;
+    }
+    Entry& entry = entries[name.substr(0, digestLength).str()];
+    entry.size += status.st_size;
+    if (name.substr(digestLength) == ".deps") {
+      entry.complete = true;
+      entry.used = status.st_mtime;
+      entry.files.insert(entry.files.begin(), path);
+    } else {
+      if (!entry.complete) {
+        entry.used = ::std::max(entry.used, status.st_mtime);
+      }
+      entry.files.push_back(path);
+    }
+  }
+  if (error) {
+    ChimeraLogger::warning("Couldn't list the AST cache " + this->directory +
+                           ": " + error.message());
+    return;
+  }
+
+  // Without its .deps, an entry is invalid before its AST is removed
+  auto removeEntry = [](const Entry& entry) {
+    for (const auto& file : entry.files) {
+      ::llvm::sys::fs::remove(file);
+    }
+  };
+  time_t now = ::time(nullptr);
+  unsigned removed = 0;
+  uint64_t totalSize = 0;
+  ::std::vector<const Entry*> kept;
+  for (const auto& entry : entries) {
+    time_t age = now - entry.second.used;
+    if ((!entry.second.complete && age > incompleteEntryAge) ||
+        (maxAge > 0 && age > 0 && static_cast<uint64_t>(age) > maxAge)) {
+      removeEntry(entry.second);
+      ++removed;
+    } else {
+      totalSize += entry.second.size;
+      kept.push_back(&entry.second);
+    }
+  }
+  // Then the least recently used ones
+  ::std::sort(kept.begin(), kept.end(), [](const Entry* a, const Entry* b) {
+    return a->used < b->used;
+  });
+  for (const Entry* entry : kept) {
+    if (maxSize == 0 || totalSize <= maxSize) {
+      break;
+    }
+    removeEntry(*entry);
+    totalSize -= entry->size;
+    ++removed;
+  }
+  if (removed > 0) {
+    ChimeraLogger::verbose("Removed " + ::std::to_string(removed) +
+                           " entries from the AST cache");
+  }
+}
@@ -24,20 +24,39 @@
 //===----------------------------------------------------------------------===//
 
 #include "Log.h"
+#include "Stats.h"
+#include "Core/MutantStore.h"
 #include "Core/MutationTemplate.h"
 #include "Testing/ChimeraTest.h"
+#include "Tooling/ASTCache.h"
 #include "Tooling/ChimeraTool.h"
 #include "Tooling/CompilationDatabaseUtils.h"
 #include "Tooling/FrontendActions.h"
 
 #include "clang/Tooling/CommonOptionsParser.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
+#ifdef LLVM_ON_UNIX
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 using namespace chimera;
 
 /// \addtogroup CHIMERA_CHIMERATOOL_CL_OPTIONS Command Line Options
@@ -97,11 +116,144 @@ enum PreprocessLevel {
                        ::llvm::cl::desc("Enable the mutants generation"),
                        ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
                        ::llvm::cl::init(false));
+::llvm::cl::opt<bool> optGenerateSchemata(
+    "schemata",
+    ::llvm::cl::desc("Save all the mutants of a source in a single file, in "
+                     "<output_dir>/mutants/<source_filename>/schemata/. The "
+                     "mutant is selected compiling with -DCHIMERA_MUTANT=<id>"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<::chimera::mutant::MutantStoreMode> optMutantStore(
+    "mutant-store", ::llvm::cl::desc("How the generated mutants are saved"),
+    ::llvm::cl::values(
+        clEnumValN(::chimera::mutant::FullMutantStore, "full",
+                   "A full copy of the source per mutant, in <id>/ (default)"),
+        clEnumValN(::chimera::mutant::PatchMutantStore, "patch",
+                   "The source once, in original/, and an edit script per "
+                   "mutant, in patches/. Use -materialize to rebuild them"),
+        clEnumValN(::chimera::mutant::PackMutantStore, "pack",
+                   "The source once, in original/, and all the edit scripts "
+                   "in mutants.pack, indexed by the fixed width records of "
+                   "mutants.idx"),
+        clEnumValEnd),
+    ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(::chimera::mutant::FullMutantStore));
+::llvm::cl::list<::chimera::mutant::ReportFormat> optReportFormats(
+    "report-format",
+    ::llvm::cl::desc("Formats of the report, comma separated, default: csv"),
+    ::llvm::cl::values(
+        clEnumValN(::chimera::mutant::CsvReport, "csv", "report.csv"),
+        clEnumValN(::chimera::mutant::NdjsonReport, "ndjson",
+                   "report.ndjson, a JSON object per line"),
+        clEnumValN(::chimera::mutant::BinaryReport, "binary",
+                   "report.bin, fixed width fields and strings"),
+        clEnumValEnd),
+    ::llvm::cl::CommaSeparated, ::llvm::cl::cat(catChimera));
+::llvm::cl::opt<::std::string> optReportPipe(
+    "report-pipe",
+    ::llvm::cl::desc("Append the report as NDJSON to a file, or named pipe, "
+                     "at the end of each source"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("path"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(""));
 ::llvm::cl::opt<bool> optNotGenerateReport(
     "no-generate-report",
     ::llvm::cl::desc("Disable the generation of the report"),
     ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
     ::llvm::cl::init(false));
+::llvm::cl::opt<::chimera::SyntaxCheckMode> optSyntaxCheckMode(
+    "syntax-check", ::llvm::cl::desc("How the mutants are syntax checked"),
+    ::llvm::cl::values(
+        clEnumValN(::chimera::FullSyntaxCheck, "full",
+                   "Parse completely each mutant"),
+        clEnumValN(::chimera::PreambleSyntaxCheck, "preamble",
+                   "Precompile the preamble once per source file and reparse "
+                   "only the mutated main file (default)"),
+        clEnumValN(::chimera::FunctionSyntaxCheck, "function",
+                   "Parse only the body of the mutated function, checking "
+                   "the whole file when it fails"),
+        clEnumValEnd),
+    ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(::chimera::PreambleSyntaxCheck));
+::llvm::cl::opt<bool> optAll(
+    "all",
+    ::llvm::cl::desc("Mutate every file of the compilation database, the "
+                     "sources can be omitted"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<unsigned> optCheckBatch(
+    "check-batch",
+    ::llvm::cl::desc("Check up to K mutants of the same function in a single "
+                     "parse, default: 1"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("K"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(1));
+::llvm::cl::opt<bool> optDedup(
+    "dedup",
+    ::llvm::cl::desc("Merge the mutants identical to a previous one: they "
+                     "aren't checked nor saved and they are reported with "
+                     "the id of the first in aliases.csv"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<bool> optSkipBodies(
+    "skip-bodies",
+    ::llvm::cl::desc("Skip the parse of the bodies of the functions not "
+                     "selected by the FunOp configuration file, in the "
+                     "analysis and in the full syntax checks"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<bool> optIncremental(
+    "incremental",
+    ::llvm::cl::desc("Keep the check results and the ids of the mutants in "
+                     "the output directory and, at the next run, check and "
+                     "save only the mutants of the functions changed since "
+                     "then"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<::std::string> optASTCache(
+    "ast-cache",
+    ::llvm::cl::desc("Keep the serialized ASTs of the sources in a directory, "
+                     "the following runs load them instead of parsing the "
+                     "unchanged sources"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("dir-path"),
+    ::llvm::cl::cat(catChimera));
+::llvm::cl::opt<unsigned> optASTCacheMaxSize(
+    "ast-cache-max-size",
+    ::llvm::cl::desc("Remove the least recently used entries of the AST "
+                     "cache above N MB, 0 for no limit, default: 1024"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("N"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(1024));
+::llvm::cl::opt<unsigned> optASTCacheMaxAge(
+    "ast-cache-max-age",
+    ::llvm::cl::desc("Remove the entries of the AST cache unused for more "
+                     "than N days, 0 for no limit, default: 30"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("N"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(30));
+::llvm::cl::opt<bool> optTimeReport(
+    "time-report",
+    ::llvm::cl::desc("Save the wall and CPU times of the phases, per source, "
+                     "operator and mutator, in <output_dir>/stats.json"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<bool> optMatcherStats(
+    "matcher-stats",
+    ::llvm::cl::desc("Count, per mutator, the matcher callbacks, the fine "
+                     "grain matches, the mutations with edits, the passed, "
+                     "failed and duplicate mutants. Printed at the end and "
+                     "saved in <output_dir>/matcher_stats.csv"),
+    ::llvm::cl::ValueDisallowed, ::llvm::cl::cat(catChimera),
+    ::llvm::cl::init(false));
+::llvm::cl::opt<::std::string> optTrace(
+    "trace",
+    ::llvm::cl::desc("Save the spans of the run (sources, matcher callbacks, "
+                     "mutate, check and save of the mutants, per thread) in "
+                     "the Chrome Trace Event format, for chrome://tracing"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("file"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(""));
+::llvm::cl::opt<unsigned> optJobs(
+    "j", ::llvm::cl::desc("Number of parallel jobs, default: 1. With more "
+                          "sources they are mutated in parallel processes, "
+                          "otherwise threads check the mutants"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("N"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(1));
 ::llvm::cl::opt<::std::string> optFunOpConfFile(
     "fun-op", ::llvm::cl::desc(
                   "The configuration file for functions/operations filtering"),
@@ -126,6 +278,19 @@ enum PreprocessLevel {
     ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("test-dir"),
     ::llvm::cl::cat(catChimera), ::llvm::cl::init(""));
 
+::llvm::cl::opt<unsigned> optMaterialize(
+    "materialize",
+    ::llvm::cl::desc("Print the source code of a generated mutant, of the "
+                     "source given by -materialize-source, whatever the "
+                     "store. This option disables the source input"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("id"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(0));
+::llvm::cl::opt<::std::string> optMaterializeSource(
+    "materialize-source",
+    ::llvm::cl::desc("The source file of the mutant to materialize"),
+    ::llvm::cl::ValueRequired, ::llvm::cl::value_desc("file"),
+    ::llvm::cl::cat(catChimera), ::llvm::cl::init(""));
+
 ::llvm::cl::opt<bool>
     optShowOperators("show-op",
                      ::llvm::cl::desc("Show the supported Mutation Operators"),
@@ -133,9 +298,223 @@ enum PreprocessLevel {
                      ::llvm::cl::init(false));
 
 // Utility functions
+/// @brief Output names of the sources whose file name isn't unique
+::std::map<::std::string, ::std::string> sourceOutputNames;
+
+/// @brief The output name of a source whose file name isn't unique:
+///        <file>-<hash>, with the MD5 prefix of its absolute path
+/// @param sourcePath The absolute path of the source
+::std::string getHashedOutputName(const ::std::string &sourcePath) {
+  ::llvm::MD5 hash;
+  hash.update(sourcePath);
+  ::llvm::MD5::MD5Result digest;
+  hash.final(digest);
+  ::llvm::SmallString<32> digestString;
+  ::llvm::MD5::stringifyResult(digest, digestString);
+  return llvm::sys::path::filename(sourcePath).str() + "-" +
+         digestString.str().substr(0, 8).str();
+}
+
+/// @brief Give a distinct output name to the sources with the same file name
+/// @details Their outputs would overwrite each other in mutants/<file>/, so
+///          they take a hashed name. The other sources keep their file name.
+/// @param sourcePaths The absolute paths of the sources
+void setSourceOutputNames(const ::std::vector<::std::string> &sourcePaths) {
+  ::std::map<::std::string, ::std::set<::std::string>> byFilename;
+  for (const auto &sourcePath : sourcePaths) {
+    byFilename[llvm::sys::path::filename(sourcePath)].insert(sourcePath);
+  }
+  sourceOutputNames.clear();
+  for (const auto &entry : byFilename) {
+    if (entry.second.size() < 2) {
+      continue;
+    }
+    for (const auto &sourcePath : entry.second) {
+      sourceOutputNames[sourcePath] = getHashedOutputName(sourcePath);
+    }
+  }
+}
+
+/// @brief If the reports of the sources are merged in summary.csv
+bool summaryReport = false;
+
+/// @brief The name of the outputs of a source, in mutants/ and resources/
+/// @param sourcePath The absolute path of the source
+::std::string getSourceOutputName(const ::std::string &sourcePath) {
+  auto name = sourceOutputNames.find(sourcePath);
+  return name != sourceOutputNames.end()
+             ? name->second
+             : llvm::sys::path::filename(sourcePath).str();
+}
+
+/// @brief Merge the reports of the sources in <mutantsDir>summary.csv
+/// @details Each line of the summary is a line of the source report, prefixed
+///          by the source output name.
+/// @param mutantsDir The directory containing the sources outputs
+/// @param sourcePaths The analyzed sources
+void writeSummary(const ::std::string &mutantsDir,
+                  const ::std::vector<::std::string> &sourcePaths) {
+  ::std::ofstream summary(mutantsDir + "summary.csv", ::std::ofstream::out);
+  if (!summary.is_open()) {
+    chimera::log::ChimeraLogger::error("Couldn't write the summary");
+    return;
+  }
+  unsigned entries = 0;
+  for (const auto &sourcePath : sourcePaths) {
+    ::std::string name = getSourceOutputName(sourcePath);
+    ::std::ifstream report(mutantsDir + name + chimera::fs::pathSep +
+                           "report.csv");
+    ::std::string line;
+    while (::std::getline(report, line)) {
+      if (!line.empty()) {
+        summary << name << "," << line << "\n";
+        ++entries;
+      }
+    }
+  }
+  summary.close();
+  chimera::log::ChimeraLogger::info(
+      "Summary: " + ::std::to_string(entries) + " mutants from " +
+      ::std::to_string(sourcePaths.size()) + " sources in " + mutantsDir +
+      "summary.csv");
+}
+
+/// @brief Names of the files in which a child process saves its times, its
+///        trace and its matcher counters
+const char *statsFragmentName = "stats.fragment";
+const char *traceFragmentName = "trace.fragment";
+const char *countersFragmentName = "counters.fragment";
+
+/// @brief Save the times, the trace and the counters of this process in
+///        <mutantsDir><source>/, to be merged by the parent process
+/// @param mutantsDir The directory containing the sources outputs
+/// @param sourcePath The source analyzed by this process
+void writeInstrumentationFragments(const ::std::string &mutantsDir,
+                                   const ::std::string &sourcePath) {
+  ::std::string directory =
+      mutantsDir + getSourceOutputName(sourcePath) + chimera::fs::pathSep;
+  chimera::fs::createDirectories(directory);
+  if (optTimeReport) {
+    ::std::error_code fileError;
+    ::llvm::raw_fd_ostream fragment(directory + statsFragmentName, fileError,
+                                    ::llvm::sys::fs::F_Text);
+    if (fileError) {
+      chimera::log::ChimeraLogger::error("Couldn't save the times of " +
+                                         sourcePath);
+    } else {
+      ::chimera::stats::StatsRegistry::get().writeSources(fragment);
+    }
+  }
+  if (optTrace != "") {
+    ::std::error_code fileError;
+    ::llvm::raw_fd_ostream fragment(directory + traceFragmentName, fileError,
+                                    ::llvm::sys::fs::F_Text);
+    if (fileError) {
+      chimera::log::ChimeraLogger::error("Couldn't save the trace of " +
+                                         sourcePath);
+    } else {
+      ::chimera::stats::TraceRecorder::get().writeEvents(fragment);
+    }
+  }
+  if (optMatcherStats) {
+    ::std::error_code fileError;
+    ::llvm::raw_fd_ostream fragment(directory + countersFragmentName,
+                                    fileError, ::llvm::sys::fs::F_Text);
+    if (fileError) {
+      chimera::log::ChimeraLogger::error("Couldn't save the counters of " +
+                                         sourcePath);
+    } else {
+      ::chimera::stats::StatsRegistry::get().writeCounters(fragment);
+    }
+  }
+}
+
+/// @brief Read and delete the fragments saved by the child processes
+/// @param mutantsDir The directory containing the sources outputs
+/// @param sourcePaths The sources analyzed by child processes
+/// @param name The name of the fragment files
+::std::vector<::std::string>
+readFragments(const ::std::string &mutantsDir,
+              const ::std::vector<::std::string> &sourcePaths,
+              const char *name) {
+  ::std::vector<::std::string> fragments;
+  ::std::set<::std::string> merged; // Sources listed more than once
+  for (const auto &sourcePath : sourcePaths) {
+    ::std::string sourceName = getSourceOutputName(sourcePath);
+    if (!merged.insert(sourceName).second) {
+      continue;
+    }
+    ::std::string fragmentPath =
+        mutantsDir + sourceName + chimera::fs::pathSep + name;
+    auto fragment = ::llvm::MemoryBuffer::getFile(fragmentPath);
+    if (fragment) {
+      fragments.push_back((*fragment)->getBuffer());
+      ::llvm::sys::fs::remove(fragmentPath);
+    }
+  }
+  return fragments;
+}
+
+/// @brief Save the times in <outputPath>stats.json, the trace in the -trace
+///        file and the matcher counters in <outputPath>matcher_stats.csv, for
+///        the enabled ones
+/// @param outputPath The output directory, with trailing separator
+/// @param sourcePaths The sources analyzed by child processes, whose
+///        fragments are merged, if any
+void writeInstrumentation(const ::std::string &outputPath,
+                          const ::std::vector<::std::string> &sourcePaths =
+                              ::std::vector<::std::string>()) {
+  ::std::string mutantsDir = outputPath + "mutants" + chimera::fs::pathSep;
+  if (optTimeReport) {
+    if (::chimera::stats::StatsRegistry::get().writeReport(
+            outputPath + "stats.json",
+            readFragments(mutantsDir, sourcePaths, statsFragmentName))) {
+      chimera::log::ChimeraLogger::info("Times saved in " + outputPath +
+                                        "stats.json");
+    } else {
+      chimera::log::ChimeraLogger::error("Couldn't write the times report");
+    }
+  }
+  if (optTrace != "") {
+    ::std::string tracePath =
+        clang::tooling::getAbsolutePath((::std::string)optTrace);
+    if (::chimera::stats::TraceRecorder::get().writeTrace(
+            tracePath,
+            readFragments(mutantsDir, sourcePaths, traceFragmentName))) {
+      chimera::log::ChimeraLogger::info("Trace saved in " + tracePath);
+    } else {
+      chimera::log::ChimeraLogger::error("Couldn't write the trace");
+    }
+  }
+  if (optMatcherStats) {
+    ::chimera::stats::StatsRegistry &registry =
+        ::chimera::stats::StatsRegistry::get();
+    for (const auto &fragment :
+         readFragments(mutantsDir, sourcePaths, countersFragmentName)) {
+      if (!registry.readCounters(fragment)) {
+        chimera::log::ChimeraLogger::warning("Corrupted matcher counters");
+      }
+    }
+    ::std::error_code fileError;
+    ::llvm::raw_fd_ostream csv(outputPath + "matcher_stats.csv", fileError,
+                               ::llvm::sys::fs::F_Text);
+    if (fileError) {
+      chimera::log::ChimeraLogger::error("Couldn't write the matcher counters");
+    } else {
+      csv << "source,operator,mutator,callbacks,fine_matches,edits,passed,"
+             "failed,duplicates\n";
+      registry.writeCounters(csv);
+    }
+    ::llvm::outs() << "Matcher statistics:\n";
+    registry.printCounters(::llvm::outs());
+  }
+}
+
 bool optIsOccured(const ::std::string &optString, int argc, const char **argv) {
   for (int i = 0; i < argc; ++i) {
-    if (argv[i] == ("-" + optString)) {
+    // Either -opt or -opt=value
+    if (argv[i] == ("-" + optString) ||
+        ::llvm::StringRef(argv[i]).startswith("-" + optString + "=")) {
       return true;
     }
   }
@@ -198,6 +577,38 @@ int chimera::ChimeraTool::run(int argc, const char **argv) {
     o.verbose = optVerbose;
     return ::chimera::testing::runAllTest(argc, argv, optExecuteTest, o);
   }
+  if (optIsOccured(optMaterialize.ArgStr, argc, argv)) {
+    llvm::cl::ParseCommandLineOptions(argc, argv, overview);
+    if (optMaterialize == 0 || optMaterializeSource == "") {
+      chimera::log::ChimeraLogger::error(
+          "-materialize requires a mutant id and -materialize-source");
+      return 1;
+    }
+    ::std::string filename = llvm::sys::path::filename(optMaterializeSource);
+    ::std::string mutantsDir =
+        clang::tooling::getAbsolutePath((::std::string)optOutputDir) +
+        chimera::fs::pathSep + "mutants" + chimera::fs::pathSep;
+    // The source may have been mutated along with another one with the same
+    // file name
+    ::std::string directory =
+        mutantsDir +
+        getHashedOutputName(clang::tooling::getAbsolutePath(
+            (::std::string)optMaterializeSource)) +
+        chimera::fs::pathSep;
+    if (!::llvm::sys::fs::is_directory(directory)) {
+      directory = mutantsDir + filename + chimera::fs::pathSep;
+    }
+    ::std::string code;
+    if (!::chimera::mutant::MutantStore::materialize(directory, filename,
+                                                    optMaterialize, code)) {
+      chimera::log::ChimeraLogger::error("Mutant " +
+                                         ::std::to_string(optMaterialize) +
+                                         " not found in " + directory);
+      return 1;
+    }
+    ::llvm::outs() << code;
+    return 0;
+  }
   ///////////////////////////////////////////////////////////////////////////////
   // From now on the source input is required
   const char **argvv;
@@ -221,8 +632,13 @@ int chimera::ChimeraTool::run(int argc, const char **argv) {
     argvv = argv;
   }
 
-  // In any case call the CommonOptionsParser
-  ::clang::tooling::CommonOptionsParser op(argc, argvv, catChimera, overview);
+  // In any case call the CommonOptionsParser, with -all the sources are
+  // optional
+  ::clang::tooling::CommonOptionsParser op(
+      argc, argvv, catChimera,
+      optIsOccured(optAll.ArgStr, argc, argvv) ? ::llvm::cl::ZeroOrMore
+                                               : ::llvm::cl::OneOrMore,
+      overview);
 
   if (optCompilationDatabaseDir != "") {
     // Free allocated resources
@@ -256,10 +672,9 @@ int chimera::ChimeraTool::run(int argc, const char **argv) {
   // Output directory
   std::string outputPath =
       clang::tooling::getAbsolutePath((::std::string)optOutputDir);
-
-  // Set resources directory
-  std::string resourcesOutputDir =
-      outputPath + chimera::fs::pathSep + "resources" + chimera::fs::pathSep;
+  ::chimera::stats::StatsRegistry::get().setEnabled(optTimeReport);
+  ::chimera::stats::StatsRegistry::get().setCountingEnabled(optMatcherStats);
+  ::chimera::stats::TraceRecorder::get().setEnabled(optTrace != "");
 
   // Options Specific actions
   ::std::unique_ptr<::clang::tooling::CompilationDatabase> userCDatabase;
@@ -289,154 +704,335 @@ int chimera::ChimeraTool::run(int argc, const char **argv) {
     }
   }
 
+  // The previous error check make safe this instruction
+  const ::clang::tooling::CompilationDatabase &compilations =
+      optCompilationDatabaseDir != "" ? *userCDatabase : op.getCompilations();
+
   // To avoid problems of directory changing during clang operations create a
-  // sourceAbsolutePathList
+  // sourceAbsolutePathList. A source listed twice, as with -all, is analyzed
+  // once: its analyses would write the same outputs
   std::vector<std::string> sourceAbsolutePathList;
+  ::std::set<::std::string> listedSources;
+  auto addSource = [&](const std::string &sourcePath) {
+    std::string absolutePath = clang::tooling::getAbsolutePath(sourcePath);
+    if (listedSources.insert(absolutePath).second) {
+      sourceAbsolutePathList.push_back(absolutePath);
+    }
+  };
   for (auto sourcePath : op.getSourcePathList()) {
-    sourceAbsolutePathList.push_back(
-        clang::tooling::getAbsolutePath(sourcePath));
+    addSource(sourcePath);
+  }
+  if (optAll) {
+    // Every file of the compilation database
+    for (auto sourcePath : compilations.getAllFiles()) {
+      addSource(sourcePath);
+    }
+    if (sourceAbsolutePathList.empty()) {
+      chimera::log::ChimeraLogger::error(
+          "The compilation database doesn't contain any file");
+      return 1;
+    }
+  }
+
+  setSourceOutputNames(sourceAbsolutePathList);
+  // The summary is merged from the report.csv of the sources
+  summaryReport = sourceAbsolutePathList.size() > 1;
+
+  // The stale entries are removed once, before the sources use the cache
+  if (optASTCache != "") {
+    ::chimera::ASTCache cache(
+        clang::tooling::getAbsolutePath((::std::string)optASTCache));
+    cache.prune(static_cast<uint64_t>(optASTCacheMaxSize) * 1024 * 1024,
+                static_cast<uint64_t>(optASTCacheMaxAge) * 24 * 3600);
+  }
+
+  // With more sources, the jobs are spent on the sources rather than on the
+  // mutant checks
+  if (optJobs > 1 && sourceAbsolutePathList.size() > 1 && !optShowFunDef) {
+    int retval = this->runOnSourcesInParallel_(
+        sourceAbsolutePathList, compilations, confMap, outputPath, optJobs);
+    writeSummary(outputPath + chimera::fs::pathSep + "mutants" +
+                     chimera::fs::pathSep,
+                 sourceAbsolutePathList);
+    writeInstrumentation(outputPath + chimera::fs::pathSep,
+                         sourceAbsolutePathList);
+    return retval;
   }
 
   // Loop on SourcePaths
-  ::std::vector<::std::string> sourcePaths = op.getSourcePathList();
   for (std::string sourcePath : sourceAbsolutePathList) {
-    // Get the compile commands for the sourcePath
-    ::chimera::cd_utils::CompileCommandVector commands;
-    if (optCompilationDatabaseDir != "") {
-      // The previous error check make safe this instruction
-      commands = chimera::cd_utils::getCompileCommandsByFilePath(*userCDatabase,
-                                                                 sourcePath);
-    } else {
-      commands = chimera::cd_utils::getCompileCommandsByFilePath(
-          op.getCompilations(), sourcePath);
+    int retval = this->runOnSource_(sourcePath, compilations, confMap,
+                                    outputPath, optJobs);
+    if (retval != 0 || optShowFunDef) {
+      return retval;
+    }
+  }
+  if (sourceAbsolutePathList.size() > 1) {
+    writeSummary(outputPath + chimera::fs::pathSep + "mutants" +
+                     chimera::fs::pathSep,
+                 sourceAbsolutePathList);
+  }
+  writeInstrumentation(outputPath + chimera::fs::pathSep);
+  return 0;
+}
+
+int chimera::ChimeraTool::runOnSourcesInParallel_(
+    const ::std::vector<::std::string> &sourcePaths,
+    const ::clang::tooling::CompilationDatabase &compilations,
+    const conf::FunOpConfMap &confMap, const ::std::string &outputPath,
+    unsigned jobs) {
+#ifdef LLVM_ON_UNIX
+  // The mutation operators keep per source state, so each source is analyzed
+  // by a child process with its own copy of them
+  ::std::map<pid_t, ::std::string> running; // Child -> source
+  int retval = 0;
+  auto waitChild = [&running, &retval]() {
+    int status;
+    pid_t child = ::waitpid(-1, &status, 0);
+    if (child <= 0) {
+      return false;
+    }
+    auto source = running.find(child);
+    if (source != running.end()) {
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        chimera::log::ChimeraLogger::error("Mutation of " + source->second +
+                                           " failed");
+        retval = 1;
+      }
+      running.erase(source);
+    }
+    return true;
+  };
+
+  for (const auto &sourcePath : sourcePaths) {
+    while (running.size() >= jobs && waitChild()) {
+    }
+    // Nothing buffered has to be duplicated in the child
+    ::llvm::outs().flush();
+    ::std::cout.flush();
+    pid_t child = ::fork();
+    if (child == 0) {
+      // Only the instrumentation of this source, merged by the parent
+      ::chimera::stats::StatsRegistry::get().clear();
+      ::chimera::stats::TraceRecorder::get().clear();
+      int childRetval =
+          this->runOnSource_(sourcePath, compilations, confMap, outputPath, 1);
+      if (optTimeReport || optTrace != "" || optMatcherStats) {
+        writeInstrumentationFragments(outputPath + chimera::fs::pathSep +
+                                          "mutants" + chimera::fs::pathSep,
+                                      sourcePath);
+      }
+      ::llvm::outs().flush();
+      ::std::cout.flush();
+      ::_exit(childRetval);
+    }
+    if (child < 0) {
+      // Analyze it here
+      chimera::log::ChimeraLogger::warning("Couldn't fork, mutating " +
+                                           sourcePath + " serially");
+      if (this->runOnSource_(sourcePath, compilations, confMap, outputPath,
+                             1) != 0) {
+        retval = 1;
+      }
+      continue;
+    }
+    running.insert(::std::make_pair(child, sourcePath));
+  }
+  while (!running.empty() && waitChild()) {
+  }
+  return retval;
+#else
+  int retval = 0;
+  for (const auto &sourcePath : sourcePaths) {
+    if (this->runOnSource_(sourcePath, compilations, confMap, outputPath,
+                           jobs) != 0) {
+      retval = 1;
     }
+  }
+  return retval;
+#endif
+}
+
+int chimera::ChimeraTool::runOnSource_(
+    ::std::string sourcePath,
+    const ::clang::tooling::CompilationDatabase &compilations,
+    const conf::FunOpConfMap &confMap, const ::std::string &outputPath,
+    unsigned validationJobs) {
+  // Set resources directory
+  std::string resourcesOutputDir =
+      outputPath + chimera::fs::pathSep + "resources" + chimera::fs::pathSep;
+
+  // The times are accounted to the source output name, as its outputs
+  const ::std::string statsSource = getSourceOutputName(sourcePath);
+  ::chimera::stats::ScopedTimer sourceTimer(statsSource, "source");
+
+  // Get the compile commands for the sourcePath
+  ::chimera::cd_utils::CompileCommandVector commands;
+  {
+    ::chimera::stats::ScopedTimer timer(statsSource, "lookup");
+    commands = chimera::cd_utils::getCompileCommandsByFilePath(compilations,
+                                                               sourcePath);
+  }
 #ifdef _CHIEMERA_DEBUG_
-    ::chimera::cd_utils::dump(::std::cout, commands);
+  ::chimera::cd_utils::dump(::std::cout, commands);
 #endif
-    // Check the emptiness
-    if (commands.empty()) {
-      chimera::log::ChimeraLogger::warning(
-          "Compile command not found. Skipping " + sourcePath);
-      continue; // Skip this iteration
-    }
-
-    // Prepare inputs for the MutationTemplate
-    ::clang::tooling::CompileCommand command = commands[0];
-
-    ///////////////////////////////////////////////////////////////////////////////
-    /// Add options/arguments
-    // Add -w to suppress warning
-    command.CommandLine.push_back("-w");
-    command.CommandLine.push_back("-fsyntax-only");
-    command.CommandLine.push_back(
-        "-Qunused-arguments"); // suppress warnings on command line arguments
-
-    // FIXME Some Bug, could not find stddef.h
-    command.CommandLine.push_back("-I/usr/lib/clang/3.9.1/include/");
-
-    ///////////////////////////////////////////////////////////////////////////////
-    // The command for the sourcePath is ready!
-    // Check source preprocessing
-    if (optPreprocessLevel != PreprocessLevel::None) {
-      PreprocessLevel l = optPreprocessLevel;
-      ::chimera::log::ChimeraLogger::verboseAndIncr(
-          "[ RUN  ] Preprocessing source file");
-      // For sure will be saved a preprocessed file version in resources
-      // directory
-
-      // Variable needed to create a raw_fd_ostream
-      ::std::error_code errorCode;
-      ::std::string filepath =
-          resourcesOutputDir + llvm::sys::path::filename(sourcePath).data();
-
-      // Create output directory
-      if (::chimera::fs::createDirectories(resourcesOutputDir)) {
-        // Open raw_fd_stream for the preprocessed-version fo the file
-        ::llvm::raw_fd_ostream preprocessSourceFileStream(
-            filepath, errorCode, llvm::sys::fs::F_Text);
-        // Check which type of preprocessing
-        if (l == PreprocessLevel::CompletePreprocess) {
-          ::chimera::log::ChimeraLogger::verbose(
-              "Applying complete preprocessing");
-          ::chimera::preprocessIncludeAction(preprocessSourceFileStream,
-                                             command, sourcePath);
-        } else if (l == PreprocessLevel::ExpandMacros) {
-          ::chimera::log::ChimeraLogger::verbose("Applying macro expansion");
-          ::chimera::expandMacrosAction(preprocessSourceFileStream, command,
-                                        sourcePath);
-        } else {
-          assert(l == PreprocessLevel::ReformatOnly);
-          ::chimera::log::ChimeraLogger::verbose("Applying reformatting");
-          ::chimera::reformatAction(preprocessSourceFileStream, command,
-                                    sourcePath);
-        }
-        // Close file stream
-        preprocessSourceFileStream.close();
-        chimera::log::ChimeraLogger::verbosePreDecr(
-            "[ DONE ] Preprocessing source file");
-
-        // A different version for the sourcePath has been created, modify
-        // command and sourcePath
-        ::chimera::cd_utils::changeCompileCommandTarget(command, sourcePath,
-                                                        filepath);
-        // Modify the sourcePath
-        sourcePath = filepath;
+  // Check the emptiness
+  if (commands.empty()) {
+    chimera::log::ChimeraLogger::warning(
+        "Compile command not found. Skipping " + sourcePath);
+    return 0; // Skip this source
+  }
 
-        chimera::log::ChimeraLogger::verbose(
-            "[ RUN  ] Performing syntax check on preprocessed file");
-        // Some times the Macro Expander corrupt the file so check the syntax
-        int syntaxCheckResult =
-            ::chimera::checkSyntaxAction(command, sourcePath);
-        if (syntaxCheckResult != 0) {
-          chimera::log::ChimeraLogger::fatal(
-              "[ FAIL ] Performing syntax check on preprocessed file\nThis "
-              "could happen for apparently no reason with the macro-expansion, "
-              "the macro-expander sometimes could not properly manage "
-              "comments, see the the first error message, if this is the case, "
-              "modify the source file in order to use this option.\nSorry for "
-              "the inconvenient.");
-          return 1;
-        } else {
-          chimera::log::ChimeraLogger::verbose(
-              "[ PASS ] Performing syntax check on preprocessed file");
-        }
-        chimera::log::ChimeraLogger::decrActualVLevel();
+  // Prepare inputs for the MutationTemplate
+  ::clang::tooling::CompileCommand command = commands[0];
+
+  ///////////////////////////////////////////////////////////////////////////////
+  /// Add options/arguments
+  // Add -w to suppress warning
+  command.CommandLine.push_back("-w");
+  command.CommandLine.push_back("-fsyntax-only");
+  command.CommandLine.push_back(
+      "-Qunused-arguments"); // suppress warnings on command line arguments
+
+  // FIXME Some Bug, could not find stddef.h
+  command.CommandLine.push_back("-I/usr/lib/clang/3.9.1/include/");
+
+  ///////////////////////////////////////////////////////////////////////////////
+  // The command for the sourcePath is ready!
+  // Check source preprocessing
+  if (optPreprocessLevel != PreprocessLevel::None) {
+    ::chimera::stats::ScopedTimer timer(statsSource, "preprocess");
+    PreprocessLevel l = optPreprocessLevel;
+    ::chimera::log::ChimeraLogger::verboseAndIncr(
+        "[ RUN  ] Preprocessing source file");
+    // For sure will be saved a preprocessed file version in resources
+    // directory
+
+    // Variable needed to create a raw_fd_ostream
+    ::std::error_code errorCode;
+    if (statsSource != llvm::sys::path::filename(sourcePath)) {
+      // Its file name isn't unique, keep the name for the language detection
+      resourcesOutputDir += statsSource + chimera::fs::pathSep;
+    }
+    ::std::string filepath =
+        resourcesOutputDir + llvm::sys::path::filename(sourcePath).data();
+
+    // Create output directory
+    if (::chimera::fs::createDirectories(resourcesOutputDir)) {
+      // Open raw_fd_stream for the preprocessed-version fo the file
+      ::llvm::raw_fd_ostream preprocessSourceFileStream(
+          filepath, errorCode, llvm::sys::fs::F_Text);
+      // Check which type of preprocessing
+      if (l == PreprocessLevel::CompletePreprocess) {
+        ::chimera::log::ChimeraLogger::verbose(
+            "Applying complete preprocessing");
+        ::chimera::preprocessIncludeAction(preprocessSourceFileStream,
+                                           command, sourcePath);
+      } else if (l == PreprocessLevel::ExpandMacros) {
+        ::chimera::log::ChimeraLogger::verbose("Applying macro expansion");
+        ::chimera::expandMacrosAction(preprocessSourceFileStream, command,
+                                      sourcePath);
       } else {
+        assert(l == PreprocessLevel::ReformatOnly);
+        ::chimera::log::ChimeraLogger::verbose("Applying reformatting");
+        ::chimera::reformatAction(preprocessSourceFileStream, command,
+                                  sourcePath);
+      }
+      // Close file stream
+      preprocessSourceFileStream.close();
+      chimera::log::ChimeraLogger::verbosePreDecr(
+          "[ DONE ] Preprocessing source file");
+
+      // A different version for the sourcePath has been created, modify
+      // command and sourcePath
+      ::chimera::cd_utils::changeCompileCommandTarget(command, sourcePath,
+                                                      filepath);
+      // Modify the sourcePath
+      sourcePath = filepath;
+
+      chimera::log::ChimeraLogger::verbose(
+          "[ RUN  ] Performing syntax check on preprocessed file");
+      // Some times the Macro Expander corrupt the file so check the syntax
+      int syntaxCheckResult =
+          ::chimera::checkSyntaxAction(command, sourcePath);
+      if (syntaxCheckResult != 0) {
         chimera::log::ChimeraLogger::fatal(
-            "Could not create the resources directory.");
-        return 1; // Error
+            "[ FAIL ] Performing syntax check on preprocessed file\nThis "
+            "could happen for apparently no reason with the macro-expansion, "
+            "the macro-expander sometimes could not properly manage "
+            "comments, see the the first error message, if this is the case, "
+            "modify the source file in order to use this option.\nSorry for "
+            "the inconvenient.");
+        return 1;
+      } else {
+        chimera::log::ChimeraLogger::verbose(
+            "[ PASS ] Performing syntax check on preprocessed file");
       }
+      chimera::log::ChimeraLogger::decrActualVLevel();
+    } else {
+      chimera::log::ChimeraLogger::fatal(
+          "Could not create the resources directory.");
+      return 1; // Error
     }
+  }
 
-    ///////////////////////////////////////////////////////////////////////////////
-    /// The command for this source file is ready, can perform FrontendAction
-    if (optShowFunDef) {
-      std::cout << "Function Definitions found : " << std::endl;
-      return ::chimera::functionDefAction(llvm::outs(), command, sourcePath);
-    }
+  ///////////////////////////////////////////////////////////////////////////////
+  /// The command for this source file is ready, can perform FrontendAction
+  if (optShowFunDef) {
+    std::cout << "Function Definitions found : " << std::endl;
+    return ::chimera::functionDefAction(llvm::outs(), command, sourcePath);
+  }
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef _CHIMERA_DEBUG_
-    chimera::cd_utils::dump(std::cout, command);
+  chimera::cd_utils::dump(std::cout, command);
 #endif
-    chimera::MutationTemplate t(command, sourcePath,
-                                outputPath + chimera::fs::pathSep + "mutants");
+  chimera::MutationTemplate t(command, sourcePath,
+                              outputPath + chimera::fs::pathSep + "mutants");
+  t.setTargetName(statsSource);
 
-    // Loop on registered operators
-    const chimera::MutationOperatorPtrMap &map = this->registeredOperatorMap;
-    for (auto it = map.begin(); it != map.end(); ++it) {
-      t.loadOperator(it->second.get());
-    }
+  // Loop on registered operators
+  const chimera::MutationOperatorPtrMap &map = this->registeredOperatorMap;
+  for (auto it = map.begin(); it != map.end(); ++it) {
+    t.loadOperator(it->second.get());
+  }
 
-    // Set if generate the mutatns or only the report
-    t.setGenerateMutants(optGenerateMutants);
-    t.setGenerateMutantsReport(!optNotGenerateReport);
-    // Analyze template
-    if (optFunOpConfFile != "") {
-      t.analyze(confMap);
-    } else {
-      t.analyze();
+  // Set if generate the mutatns or only the report
+  t.setGenerateMutants(optGenerateMutants);
+  t.setGenerateMutantsReport(!optNotGenerateReport);
+  t.setGenerateSchemata(optGenerateSchemata);
+  t.setMutantStoreMode(optMutantStore);
+  if (!optReportFormats.empty()) {
+    ::std::vector<::chimera::mutant::ReportFormat> formats(
+        optReportFormats.begin(), optReportFormats.end());
+    if (summaryReport &&
+        ::std::find(formats.begin(), formats.end(),
+                    ::chimera::mutant::CsvReport) == formats.end()) {
+      chimera::log::ChimeraLogger::verbose(
+          "Writing report.csv too, the summary is merged from it");
+      formats.push_back(::chimera::mutant::CsvReport);
     }
+    t.setReportFormats(formats);
+  }
+  if (optReportPipe != "") {
+    t.setReportPipe(
+        clang::tooling::getAbsolutePath((::std::string)optReportPipe));
+  }
+  t.setSyntaxCheckMode(optSyntaxCheckMode);
+  t.setValidationJobs(validationJobs);
+  t.setCheckBatchSize(optCheckBatch);
+  t.setDeduplicateMutants(optDedup);
+  t.setSkipFunctionBodies(optSkipBodies);
+  t.setIncremental(optIncremental);
+  if (optASTCache != "") {
+    t.setASTCache(::std::make_shared<::chimera::ASTCache>(
+        clang::tooling::getAbsolutePath((::std::string)optASTCache)));
+  }
+  // Analyze template
+  if (optFunOpConfFile != "") {
+    t.analyze(confMap);
+  } else {
+    t.analyze();
   }
   return 0;
 }
@@ -29,6 +29,7 @@
 #include "clang/AST/Decl.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Basic/FileManager.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Frontend/PreprocessorOutputOptions.h"
@@ -36,6 +37,7 @@
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/Rewrite/Frontend/Rewriters.h"
 #include "clang/Rewrite/Frontend/ASTConsumers.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
 
 using namespace clang::ast_matchers;
 using namespace clang::tooling;
@@ -87,6 +89,88 @@ int chimera::checkSyntaxAction(const ::clang::tooling::CompileCommand& c,
       newFrontendActionFactory<clang::SyntaxOnlyAction>().get());
 }
 
+/// @brief Run a syntax only action on an in-memory version of the source file
+/// @details Unlike ClangTool::run, the working directory of the process isn't
+///          changed, so the check can run while other threads resolve
+///          relative paths. The relative paths of the command are resolved
+///          passing its directory explicitly, as the PreambleSyntaxChecker
+///          does.
+/// @param action The action to run, the invocation takes its ownership
+/// @return 0 if the check passed
+static int runSyntaxOnlyInvocation(clang::FrontendAction* action,
+                                   const ::clang::tooling::CompileCommand& c,
+                                   const ::std::string& sourceFilePath,
+                                   ::llvm::StringRef code) {
+  // The same adjustments applied by the ClangTool
+  CommandLineArguments arguments =
+      getClangSyntaxOnlyAdjuster()(c.CommandLine, sourceFilePath);
+  arguments = getClangStripOutputAdjuster()(arguments, sourceFilePath);
+  arguments.push_back("-working-directory");
+  arguments.push_back(c.Directory);
+
+  clang::FileSystemOptions fileSystemOptions;
+  fileSystemOptions.WorkingDir = c.Directory;
+  ::llvm::IntrusiveRefCntPtr<clang::FileManager> files(
+      new clang::FileManager(fileSystemOptions));
+  ToolInvocation invocation(::std::move(arguments), action, files.get());
+  // Overlay the file content with the in-memory code
+  invocation.mapVirtualFile(sourceFilePath, code);
+  return invocation.run() ? 0 : 1;
+}
+
+int chimera::checkSyntaxAction(const ::clang::tooling::CompileCommand& c,
+                               const ::std::string& sourceFilePath,
+                               ::llvm::StringRef code) {
+  return runSyntaxOnlyInvocation(new clang::SyntaxOnlyAction(), c,
+                                 sourceFilePath, code);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool chimera::FunctionBodyFilterConsumer::shouldSkipFunctionBody(
+    clang::Decl* D) {
+  const clang::FunctionDecl* function = D->getAsFunction();
+  return function == nullptr || !this->filter(*function);
+}
+
+chimera::FunctionSyntaxOnlyAction::FunctionSyntaxOnlyAction(
+    const ::std::string& functionName)
+    : filter([functionName](const clang::FunctionDecl& function) {
+        return function.getQualifiedNameAsString() == functionName;
+      }) {
+}
+
+bool chimera::FunctionSyntaxOnlyAction::BeginInvocation(
+    clang::CompilerInstance& CI) {
+  CI.getFrontendOpts().SkipFunctionBodies = true;
+  return clang::SyntaxOnlyAction::BeginInvocation(CI);
+}
+
+::std::unique_ptr<clang::ASTConsumer>
+chimera::FunctionSyntaxOnlyAction::CreateASTConsumer(
+    clang::CompilerInstance& CI, llvm::StringRef sourcePath) {
+  return ::llvm::make_unique<FunctionBodyFilterConsumer>(this->filter);
+}
+
+int chimera::checkSyntaxAction(const ::clang::tooling::CompileCommand& c,
+                               const ::std::string& sourceFilePath,
+                               ::llvm::StringRef code,
+                               const FunctionBodyFilter& filter) {
+  return runSyntaxOnlyInvocation(new FunctionSyntaxOnlyAction(filter), c,
+                                 sourceFilePath, code);
+}
+
+int chimera::checkFunctionSyntaxAction(
+    const ::clang::tooling::CompileCommand& c,
+    const ::std::string& sourceFilePath, ::llvm::StringRef code,
+    const ::std::string& functionName) {
+  return checkSyntaxAction(
+      c, sourceFilePath, code,
+      [&functionName](const clang::FunctionDecl& function) {
+        return function.getQualifiedNameAsString() == functionName;
+      });
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void chimera::PreprocessIncludeAction::EndSourceFileAction() {
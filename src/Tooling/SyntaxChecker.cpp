@@ -0,0 +1,121 @@
+//===- SyntaxChecker.cpp ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file SyntaxChecker.cpp
+/// \author Federico Iannucci
+/// \brief  This file implements the syntax checkers for the mutants
+//===----------------------------------------------------------------------===//
+
+#include "Log.h"
+#include "Tooling/SyntaxChecker.h"
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <vector>
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace chimera::log;
+
+/// Anchor used to locate the clang resources relative to the executable
+static int resourcesAnchor;
+
+chimera::PreambleSyntaxChecker::PreambleSyntaxChecker(
+    const CompileCommand& command, const ::std::string& sourceFilePath)
+    : command(command),
+      sourceFilePath(sourceFilePath),
+      pchContainerOps(::std::make_shared<PCHContainerOperations>()),
+      unit(nullptr),
+      loadFailed(false) {
+}
+
+chimera::PreambleSyntaxChecker::~PreambleSyntaxChecker() {
+}
+
+bool chimera::PreambleSyntaxChecker::load_(::llvm::StringRef code) {
+  // Arguments as the driver would receive them. The ASTUnit doesn't change
+  // the working directory as the ClangTool does, so relative paths of the
+  // command are resolved passing its directory explicitly.
+  ::std::vector<::std::string> arguments = this->command.CommandLine;
+  arguments.push_back("-working-directory");
+  arguments.push_back(this->command.Directory);
+  ::std::vector<const char*> argv;
+  for (const auto& argument : arguments) {
+    argv.push_back(argument.c_str());
+  }
+
+  IntrusiveRefCntPtr<DiagnosticsEngine> diagnostics =
+      CompilerInstance::createDiagnostics(new DiagnosticOptions());
+  ::std::string resourcesPath = CompilerInvocation::GetResourcesPath(
+      argv[0], static_cast<void*>(&resourcesAnchor));
+
+  // The ASTUnit takes the ownership of the remapped buffer
+  ASTUnit::RemappedFile mainFile(
+      this->sourceFilePath,
+      ::llvm::MemoryBuffer::getMemBufferCopy(code, this->sourceFilePath)
+          .release());
+
+  // The preamble is precompiled at the first reparse, from then on it is
+  // reused as long as the leading directives of the main file don't change
+  this->unit.reset(ASTUnit::LoadFromCommandLine(
+      argv.data(), argv.data() + argv.size(), this->pchContainerOps,
+      diagnostics, resourcesPath, /* OnlyLocalDecls */ false,
+      /* CaptureDiagnostics */ false, mainFile,
+      /* RemappedFilesKeepOriginalName */ true,
+      /* PrecompilePreamble */ true));
+
+  if (!this->unit) {
+    ChimeraLogger::warning("Couldn't load the translation unit of " +
+                           this->sourceFilePath +
+                           ", the preamble won't be reused");
+    this->loadFailed = true;
+    return false;
+  }
+  return true;
+}
+
+bool chimera::PreambleSyntaxChecker::check(::llvm::StringRef code,
+                                           bool& passed) {
+  if (this->loadFailed) {
+    return false;
+  }
+  if (!this->unit) {
+    // First check: the loading parses code itself
+    if (!this->load_(code)) {
+      return false;
+    }
+    passed = !this->unit->getDiagnostics().hasErrorOccurred();
+    return true;
+  }
+  // Reparse the main file only, on the new content
+  ASTUnit::RemappedFile mainFile(
+      this->sourceFilePath,
+      ::llvm::MemoryBuffer::getMemBufferCopy(code, this->sourceFilePath)
+          .release());
+  bool reparseFailed = this->unit->Reparse(this->pchContainerOps, mainFile);
+  passed = !reparseFailed && !this->unit->getDiagnostics().hasErrorOccurred();
+  return true;
+}
@@ -91,3 +91,17 @@ bool chimera::fs::createDirectories(const llvm::Twine& path,
   sys::fs::create_directories(path, ignoreExisting);
   return sys::fs::is_directory(path);
 }
+
+void chimera::fs::deleteDirectory(const llvm::Twine& path) {
+  // The entries are visited before their children, remove them backwards
+  std::vector<std::string> entries;
+  std::error_code error;
+  for (sys::fs::recursive_directory_iterator entry(path, error), end;
+       entry != end && !error; entry.increment(error)) {
+    entries.push_back(entry->path());
+  }
+  for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+    sys::fs::remove(*entry);
+  }
+  sys::fs::remove(path);
+}
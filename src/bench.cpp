@@ -0,0 +1,571 @@
+//===- bench.cpp ------------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2015, 2016  Federico Iannucci (fed.iannucci@gmail.com)
+//
+//  This file is part of Clang-Chimera.
+//
+//  Clang-Chimera is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Clang-Chimera is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with Clang-Chimera. If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/// \file bench.cpp
+/// \author Federico Iannucci
+/// \brief Benchmark main function: the registered operators are run on
+///        synthetic translation units, or on a corpus of kernels, and their
+///        throughput is reported
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark/KernelCorpus.h"
+#include "Benchmark/SourceGenerator.h"
+#include "Core/MutationTemplate.h"
+#include "Log.h"
+#include "Operators/Operators.h"
+#include "Stats.h"
+#include "Utils.h"
+
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace chimera;
+
+// Categories
+::llvm::cl::OptionCategory catBench("chimera-bench options");
+
+// Shape of the translation units
+::llvm::cl::opt<unsigned> optGroups(
+    "groups", ::llvm::cl::desc("Function groups of the smallest translation "
+                               "unit, each with a float, a loop and an "
+                               "integer function, default: 20"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(20));
+::llvm::cl::list<unsigned> optScales(
+    "scale", ::llvm::cl::desc("Multipliers of the function groups, comma "
+                              "separated, default: 1,4"),
+    ::llvm::cl::CommaSeparated, ::llvm::cl::value_desc("K"),
+    ::llvm::cl::cat(catBench));
+::llvm::cl::opt<unsigned> optFloatExpressions(
+    "float-exprs",
+    ::llvm::cl::desc("Float expressions per float function, default: 8"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(8));
+::llvm::cl::opt<unsigned>
+    optLoops("loops",
+             ::llvm::cl::desc("Loop nests per loop function, default: 2"),
+             ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catBench),
+             ::llvm::cl::init(2));
+::llvm::cl::opt<unsigned>
+    optLoopDepth("loop-depth",
+                 ::llvm::cl::desc("Depth of the loop nests, default: 2"),
+                 ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catBench),
+                 ::llvm::cl::init(2));
+::llvm::cl::opt<unsigned> optAddChains(
+    "add-chains",
+    ::llvm::cl::desc("Add chains per integer function, default: 4"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(4));
+::llvm::cl::opt<unsigned> optAddChainLength(
+    "add-chain-length",
+    ::llvm::cl::desc("Operands of the add chains, default: 4"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(4));
+
+// Kernels
+::llvm::cl::opt<::std::string> optKernels(
+    "kernels", ::llvm::cl::desc("Run the operators on the kernels of a "
+                                "corpus, as test/kernels, instead of "
+                                "synthetic translation units"),
+    ::llvm::cl::value_desc("dir-path"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(""));
+::llvm::cl::opt<bool> optRunMutants(
+    "run-mutants",
+    ::llvm::cl::desc("Build the mutants of the kernels with their driver, run "
+                     "them and compare their output with the golden one"),
+    ::llvm::cl::cat(catBench), ::llvm::cl::init(false));
+::llvm::cl::opt<::std::string> optCompiler(
+    "cxx", ::llvm::cl::desc("Compiler of the mutants, default: c++"),
+    ::llvm::cl::value_desc("compiler"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init("c++"));
+::llvm::cl::opt<::std::string> optCompilerFlags(
+    "cxx-flags",
+    ::llvm::cl::desc("Flags of the compiler of the mutants, space separated, "
+                     "as the ones of the approximate computing libraries"),
+    ::llvm::cl::value_desc("flags"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init("-O2"));
+::llvm::cl::opt<unsigned> optRunTimeout(
+    "run-timeout",
+    ::llvm::cl::desc("Seconds a mutant can run, 0 for no limit, default: 10"),
+    ::llvm::cl::value_desc("seconds"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(10));
+
+// Run
+::llvm::cl::list<::std::string> optOperators(
+    "op", ::llvm::cl::desc("Operators to run, comma separated, default: all"),
+    ::llvm::cl::CommaSeparated, ::llvm::cl::value_desc("id"),
+    ::llvm::cl::cat(catBench));
+::llvm::cl::opt<::chimera::SyntaxCheckMode> optSyntaxCheckMode(
+    "syntax-check", ::llvm::cl::desc("How the mutants are syntax checked"),
+    ::llvm::cl::values(
+        clEnumValN(::chimera::FullSyntaxCheck, "full", "Full parse"),
+        clEnumValN(::chimera::PreambleSyntaxCheck, "preamble",
+                   "Precompiled preamble (default)"),
+        clEnumValN(::chimera::FunctionSyntaxCheck, "function",
+                   "Mutated function only"),
+        clEnumValEnd),
+    ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(::chimera::PreambleSyntaxCheck));
+::llvm::cl::opt<unsigned> optJobs(
+    "j", ::llvm::cl::desc("Threads checking the mutants, default: 1"),
+    ::llvm::cl::value_desc("N"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(1));
+::llvm::cl::opt<unsigned> optCheckBatch(
+    "check-batch",
+    ::llvm::cl::desc("Mutants of a function checked in a single parse, "
+                     "default: 1"),
+    ::llvm::cl::value_desc("K"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(1));
+::llvm::cl::opt<bool> optSkipBodies(
+    "skip-bodies",
+    ::llvm::cl::desc("Skip the bodies of the functions not in the FunOp "
+                     "configuration of a kernel"),
+    ::llvm::cl::cat(catBench), ::llvm::cl::init(false));
+::llvm::cl::opt<::std::string> optASTCache(
+    "ast-cache",
+    ::llvm::cl::desc("Directory of the serialized ASTs, the operators after "
+                     "the first one load the AST of an input"),
+    ::llvm::cl::value_desc("dir-path"), ::llvm::cl::cat(catBench));
+::llvm::cl::opt<::std::string> optOutputDir(
+    "o", ::llvm::cl::desc("Directory of the translation units and of the "
+                          "outputs, default: ./chimera_bench"),
+    ::llvm::cl::value_desc("dir-path"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init("./chimera_bench"));
+::llvm::cl::opt<::std::string> optCsv(
+    "csv", ::llvm::cl::desc("Append the results to a CSV file"),
+    ::llvm::cl::value_desc("file"), ::llvm::cl::cat(catBench),
+    ::llvm::cl::init(""));
+
+/// @brief A translation unit of the benchmark
+struct BenchInput {
+  BenchInput() : kernel(nullptr) {}
+
+  ::std::string label;         ///< Shown in the results
+  ::std::string sourcePath;    ///< The translation unit
+  ::std::string outputDir;     ///< Directory of the outputs, with pathSep
+  conf::FunOpConfMap confMap;  ///< Functions/operators, empty for all
+  const bench::Kernel *kernel; ///< The kernel, nullptr if synthetic
+};
+
+/// @brief The results of an operator on a translation unit
+struct BenchResult {
+  BenchResult()
+      : mutants(0), passed(0), total(0), peakRss(-1), ran(0), golden(0),
+        meanError(0) {}
+
+  uint64_t mutants;         ///< Mutations that changed the source
+  uint64_t passed;          ///< Mutants that passed the check
+  double total;             ///< Wall seconds of the analysis
+  stats::PhaseTime parse;   ///< Parse of the translation unit
+  stats::PhaseTime matcher; ///< Matcher traversal, callbacks included
+  stats::PhaseTime check;   ///< Mutant checks, on all the threads
+  long peakRss;             ///< Peak resident set in KB, -1 if unknown
+  unsigned ran;             ///< Kernel mutants built and run
+  unsigned golden;          ///< Kernel mutants with the golden output
+  double meanError;         ///< Mean output error of the run mutants
+};
+
+/// @brief Peak resident set of this process in KB, -1 if unknown
+static long getPeakRss() {
+#ifdef LLVM_ON_UNIX
+  struct rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+    return usage.ru_maxrss;
+  }
+#endif
+  return -1;
+}
+
+/// @brief Build and run the mutants of a kernel, saved as full sources in
+///        <mutantsDir><id>/kernel.cpp, comparing their outputs with the
+///        golden one
+static void runMutants(const bench::Kernel &kernel,
+                       const bench::KernelRunner &runner,
+                       const ::std::string &mutantsDir, BenchResult &result) {
+  auto golden = ::llvm::MemoryBuffer::getFile(kernel.getGoldenPath());
+  if (!golden) {
+    log::ChimeraLogger::error("Couldn't read " + kernel.getGoldenPath());
+    return;
+  }
+  double errorSum = 0;
+  ::std::error_code error;
+  for (::llvm::sys::fs::directory_iterator entry(mutantsDir, error), end;
+       entry != end && !error; entry.increment(error)) {
+    ::llvm::StringRef id = ::llvm::sys::path::filename(entry->path());
+    ::std::string mutantDir = entry->path() + fs::pathSep;
+    if (id.empty() || id.find_first_not_of("0123456789") != id.npos ||
+        !::llvm::sys::fs::exists(mutantDir + "kernel.cpp")) {
+      continue;
+    }
+    ::std::string output;
+    if (!runner.buildAndRun(kernel, mutantDir + "kernel.cpp", mutantDir,
+                            output)) {
+      continue;
+    }
+    ++result.ran;
+    bench::OutputError outputError =
+        bench::compareOutput(output, (*golden)->getBuffer());
+    if (outputError.identical) {
+      ++result.golden;
+    }
+    // An output that can't be compared counts as completely wrong
+    errorSum += outputError.comparable ? outputError.error : 1;
+  }
+  if (result.ran > 0) {
+    result.meanError = errorSum / result.ran;
+  }
+}
+
+/// @brief Run an operator on a translation unit
+/// @param runner The runner of the kernel mutants, nullptr to not run them
+static BenchResult runOperator(m_operator::MutationOperator &op,
+                               const BenchInput &input,
+                               const bench::KernelRunner *runner) {
+  // The same command of ChimeraTool
+  ::clang::tooling::CompileCommand command;
+  command.Directory = input.outputDir;
+  command.CommandLine = {"clang++", "-std=c++11", input.sourcePath, "-w",
+                         "-fsyntax-only", "-Qunused-arguments",
+                         "-I/usr/lib/clang/3.9.1/include/"};
+
+  // The kernel mutants are run from their full sources
+  bool generateMutants = input.kernel != nullptr && runner != nullptr;
+  stats::StatsRegistry &registry = stats::StatsRegistry::get();
+  registry.clear();
+  MutationTemplate t(command, input.sourcePath, input.outputDir + "mutants");
+  t.loadOperator(&op);
+  t.setGenerateMutants(generateMutants);
+  t.setMutantStoreMode(mutant::FullMutantStore);
+  t.setGenerateMutantsReport(true);
+  t.setSyntaxCheckMode(optSyntaxCheckMode);
+  t.setValidationJobs(optJobs);
+  t.setCheckBatchSize(optCheckBatch);
+  t.setSkipFunctionBodies(optSkipBodies);
+  if (optASTCache != "") {
+    t.setASTCache(::std::make_shared<ASTCache>(
+        ::clang::tooling::getAbsolutePath((::std::string)optASTCache)));
+  }
+  stats::Stopwatch stopwatch;
+  if (input.confMap.empty()) {
+    t.analyze();
+  } else {
+    t.analyze(input.confMap);
+  }
+
+  BenchResult result;
+  result.total = stopwatch.elapsed().wall;
+  ::std::string source = t.getTargetName();
+  stats::MatcherCounters counters = registry.getCounters(source);
+  result.mutants = counters.values[stats::EditCounter];
+  result.passed = counters.values[stats::PassedCounter];
+  result.parse = registry.getPhaseTime(source, "parse");
+  // The checks run or waited for by the traversal aren't matcher time
+  stats::PhaseTime traversal = registry.getPhaseTime(source, "traversal");
+  stats::PhaseTime checkWait = registry.getPhaseTime(source, "check wait");
+  result.matcher.wall = ::std::max(traversal.wall - checkWait.wall, 0.0);
+  result.matcher.cpu = ::std::max(traversal.cpu - checkWait.cpu, 0.0);
+  result.matcher.count = traversal.count;
+  result.check = registry.getPhaseTime(source, "check");
+  result.peakRss = getPeakRss();
+  if (generateMutants) {
+    runMutants(*input.kernel, *runner, t.getTargetOutputDirectory(), result);
+  }
+  return result;
+}
+
+/// @brief Print the header of the results table
+static void printHeader() {
+  ::llvm::outs() << "Operator             Input           Mutants   Passed"
+                    "  Mutants/s   Total s   Parse s Matcher s   Check s"
+                    " PeakRSS KB";
+  if (optRunMutants) {
+    ::llvm::outs() << "      Ran   Golden Mean error";
+  }
+  ::llvm::outs() << "\n";
+}
+
+/// @brief Print a result as a table row and, if required, as a CSV line
+static void printResult(const ::std::string &operatorId,
+                        const ::std::string &input,
+                        const BenchResult &result) {
+  double throughput = result.total > 0 ? result.mutants / result.total : 0;
+  ::llvm::outs() << ::llvm::format(
+      "%-20s %-14s %8llu %8llu %10.1f %9.3f %9.3f %9.3f %9.3f %10ld",
+      operatorId.c_str(), input.c_str(),
+      static_cast<unsigned long long>(result.mutants),
+      static_cast<unsigned long long>(result.passed), throughput,
+      result.total, result.parse.wall, result.matcher.wall,
+      result.check.wall, result.peakRss);
+  if (optRunMutants) {
+    ::llvm::outs() << ::llvm::format(" %8u %8u %10.6f", result.ran,
+                                     result.golden, result.meanError);
+  }
+  ::llvm::outs() << "\n";
+  ::llvm::outs().flush();
+  if (optCsv != "") {
+    // The rows are appended, the header is written only into a new file
+    uint64_t csvSize = 0;
+    bool newCsv = ::llvm::sys::fs::file_size((::std::string)optCsv, csvSize) ||
+                  csvSize == 0;
+    ::std::error_code fileError;
+    ::llvm::raw_fd_ostream csv((::std::string)optCsv, fileError,
+                               ::llvm::sys::fs::F_Append);
+    if (fileError) {
+      log::ChimeraLogger::error("Couldn't open " + (::std::string)optCsv);
+      return;
+    }
+    if (newCsv) {
+      csv << "operator,input,mutants,passed,mutants_per_s,total_s,parse_s,"
+             "matcher_s,check_s,peak_rss_kb";
+      if (optRunMutants) {
+        csv << ",ran,golden,mean_error";
+      }
+      csv << "\n";
+    }
+    csv << operatorId << "," << input << "," << result.mutants << ","
+        << result.passed << "," << ::llvm::format("%.3f", throughput) << ","
+        << ::llvm::format("%.6f", result.total) << ","
+        << ::llvm::format("%.6f", result.parse.wall) << ","
+        << ::llvm::format("%.6f", result.matcher.wall) << ","
+        << ::llvm::format("%.6f", result.check.wall) << "," << result.peakRss;
+    if (optRunMutants) {
+      csv << "," << result.ran << "," << result.golden << ","
+          << ::llvm::format("%.6f", result.meanError);
+    }
+    csv << "\n";
+  }
+}
+
+/// @brief Run an operator on a translation unit and print its result
+/// @details Each run is done by a child process, so that the peak resident
+///          set is its own and the operator state doesn't leak into the
+///          next runs
+/// @return If the run succeeded
+static bool benchOperator(m_operator::MutationOperator &op,
+                          const BenchInput &input,
+                          const bench::KernelRunner *runner) {
+#ifdef LLVM_ON_UNIX
+  ::llvm::outs().flush();
+  pid_t child = ::fork();
+  if (child == 0) {
+    printResult(op.getIdentifier(), input.label,
+                runOperator(op, input, runner));
+    ::_exit(0);
+  }
+  if (child > 0) {
+    int status;
+    return ::waitpid(child, &status, 0) == child && WIFEXITED(status) &&
+           WEXITSTATUS(status) == 0;
+  }
+  log::ChimeraLogger::warning("Couldn't fork, running in process");
+#endif
+  printResult(op.getIdentifier(), input.label, runOperator(op, input, runner));
+  return true;
+}
+
+/// @brief If an operator has been selected with -op
+static bool isSelected(const m_operator::MutationOperator &op) {
+  return optOperators.empty() ||
+         ::std::find(optOperators.begin(), optOperators.end(),
+                     op.getIdentifier()) != optOperators.end();
+}
+
+/// @brief Run the operators on synthetic translation units of growing size
+/// @return The exit code
+static int benchSynthetic(
+    const ::std::vector<m_operator::MutationOperatorPtr> &operators,
+    const ::std::string &outputDir) {
+  ::std::vector<unsigned> scales(optScales.begin(), optScales.end());
+  if (scales.empty()) {
+    scales = {1, 4};
+  }
+  printHeader();
+  int retval = 0;
+  for (unsigned scale : scales) {
+    bench::SourceShape shape;
+    shape.groups = optGroups * scale;
+    shape.floatExpressions = optFloatExpressions;
+    shape.loops = optLoops;
+    shape.loopDepth = optLoopDepth;
+    shape.addChains = optAddChains;
+    shape.addChainLength = optAddChainLength;
+    // A file per size, so that the outputs don't mix
+    BenchInput input;
+    input.label = ::std::to_string(shape.groups) + " groups";
+    input.sourcePath =
+        outputDir + "bench_" + ::std::to_string(shape.groups) + ".cpp";
+    input.outputDir = outputDir;
+    ::std::error_code fileError;
+    {
+      ::llvm::raw_fd_ostream source(input.sourcePath, fileError,
+                                    ::llvm::sys::fs::F_Text);
+      if (fileError) {
+        log::ChimeraLogger::error("Couldn't write " + input.sourcePath);
+        return 1;
+      }
+      source << bench::generateSource(shape);
+    }
+    for (const auto &op : operators) {
+      if (!isSelected(*op)) {
+        continue;
+      }
+      if (!benchOperator(*op, input, nullptr)) {
+        log::ChimeraLogger::error(op->getIdentifier() + " failed on " +
+                                  input.sourcePath);
+        retval = 1;
+      }
+    }
+  }
+  return retval;
+}
+
+/// @brief Run the operators on the kernels of a corpus, each operator only on
+///        the kernels whose configuration lists it
+/// @return The exit code
+static int
+benchKernels(const ::std::vector<m_operator::MutationOperatorPtr> &operators,
+             const ::std::string &outputDir) {
+  ::std::vector<bench::Kernel> kernels = bench::findKernels(
+      ::clang::tooling::getAbsolutePath((::std::string)optKernels));
+  if (kernels.empty()) {
+    log::ChimeraLogger::error("No kernels in " + (::std::string)optKernels);
+    return 1;
+  }
+  ::std::unique_ptr<bench::KernelRunner> runner;
+  if (optRunMutants) {
+    ::llvm::SmallVector<::llvm::StringRef, 8> flagRefs;
+    ::llvm::SplitString(optCompilerFlags, flagRefs);
+    ::std::vector<::std::string> flags;
+    for (::llvm::StringRef flag : flagRefs) {
+      flags.push_back(flag.str());
+    }
+    runner.reset(new bench::KernelRunner(optCompiler, flags, optRunTimeout));
+    if (!runner->isValid()) {
+      log::ChimeraLogger::error("Couldn't find " + (::std::string)optCompiler);
+      return 1;
+    }
+  }
+
+  printHeader();
+  int retval = 0;
+  for (const bench::Kernel &kernel : kernels) {
+    BenchInput input;
+    input.label = kernel.name;
+    input.sourcePath = kernel.getKernelPath();
+    input.kernel = &kernel;
+    if (!conf::readFunctionsOperatorsConfFile(kernel.getConfPath(),
+                                              input.confMap)) {
+      log::ChimeraLogger::error("Couldn't read " + kernel.getConfPath());
+      retval = 1;
+      continue;
+    }
+    ::std::string kernelOutputDir =
+        outputDir + "kernels" + fs::pathSep + kernel.name + fs::pathSep;
+    if (runner) {
+      // The mutants are compared with the golden output of the original
+      ::std::string originalDir = kernelOutputDir + "original" + fs::pathSep;
+      fs::createDirectories(originalDir);
+      ::std::string output;
+      auto golden = ::llvm::MemoryBuffer::getFile(kernel.getGoldenPath());
+      if (!runner->buildAndRun(kernel, kernel.getKernelPath(), originalDir,
+                               output) ||
+          !golden ||
+          !bench::compareOutput(output, (*golden)->getBuffer()).identical) {
+        log::ChimeraLogger::warning("The original " + kernel.name +
+                                    " doesn't give its golden output");
+      }
+    }
+    for (const auto &op : operators) {
+      if (!isSelected(*op)) {
+        continue;
+      }
+      // Only the operators of the kernel configuration
+      bool configured = false;
+      for (const auto &row : input.confMap) {
+        for (const ::std::string &operatorId : row.second) {
+          configured |= operatorId == op->getIdentifier() ||
+                        operatorId == "CHIMERA_ALL_OPERATORS";
+        }
+      }
+      if (!configured) {
+        continue;
+      }
+      // A directory per operator, so that their mutants don't mix
+      input.outputDir = kernelOutputDir + op->getIdentifier() + fs::pathSep;
+      fs::deleteDirectory(input.outputDir);
+      if (!fs::createDirectories(input.outputDir)) {
+        log::ChimeraLogger::error("Couldn't create " + input.outputDir);
+        return 1;
+      }
+      if (!benchOperator(*op, input, runner.get())) {
+        log::ChimeraLogger::error(op->getIdentifier() + " failed on " +
+                                  kernel.name);
+        retval = 1;
+      }
+    }
+  }
+  return retval;
+}
+
+int main(int argc, const char **argv) {
+  log::ChimeraLogger::init();
+  ::llvm::cl::HideUnrelatedOptions(catBench);
+  ::llvm::cl::ParseCommandLineOptions(
+      argc, argv, "Run the mutation operators on synthetic translation units, "
+                  "or on a corpus of kernels, and report their throughput\n");
+
+  ::std::vector<m_operator::MutationOperatorPtr> operators = getOperators();
+
+  ::std::string outputDir =
+      ::clang::tooling::getAbsolutePath((::std::string)optOutputDir);
+  if (outputDir.back() != fs::pathSep) {
+    outputDir.push_back(fs::pathSep);
+  }
+  if (!fs::createDirectories(outputDir)) {
+    log::ChimeraLogger::error("Couldn't create " + outputDir);
+    return 1;
+  }
+  stats::StatsRegistry::get().setEnabled(true);
+  stats::StatsRegistry::get().setCountingEnabled(true);
+
+  if (optKernels != "") {
+    return benchKernels(operators, outputDir);
+  }
+  return benchSynthetic(operators, outputDir);
+}
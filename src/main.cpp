@@ -33,14 +33,9 @@ int main(int argc, const char **argv) {
   // Create a Chimera Tool
   ::chimera::ChimeraTool chimeraTool;
   
-  chimeraTool.registerMutationOperator(::chimera::flapmutator::getFLAPOperator());
-  chimeraTool.registerMutationOperator(::chimera::vpamutator::getVPAOperator());
-  chimeraTool.registerMutationOperator(::chimera::vpa_nmutator::getVPANOperator());
-  chimeraTool.registerMutationOperator(::chimera::perforation::getPerforationFirstOperator());
-  chimeraTool.registerMutationOperator(::chimera::perforation::getPerforationSecondOperator());
-  chimeraTool.registerMutationOperator(::chimera::adder::getAdderOperator());
-  chimeraTool.registerMutationOperator(::chimera::axdct::getAxDCTOperator());
-
+  for (auto &op : ::chimera::getOperators()) {
+    chimeraTool.registerMutationOperator(std::move(op));
+  }
 
   return chimeraTool.run(argc, argv);
 }
@@ -0,0 +1,31 @@
+// Driver of dct8x8: a block of pseudo random pixels, the coefficients printed
+// one per line
+
+#include <cmath>
+#include <cstdio>
+
+void dct8x8(const float block[8][8], const float cosTable[8][8],
+            float coeffs[8][8]);
+
+static const double pi = 3.14159265358979323846;
+
+int main() {
+  float block[8][8];
+  float cosTable[8][8];
+  float coeffs[8][8] = {};
+  unsigned seed = 12345;
+  for (int x = 0; x < 8; x++) {
+    for (int y = 0; y < 8; y++) {
+      seed = seed * 1103515245u + 12345u;
+      block[x][y] = (float)((seed >> 16) % 256) - 128.0f;
+      cosTable[x][y] = (float)std::cos((2 * x + 1) * y * pi / 16);
+    }
+  }
+  dct8x8(block, cosTable, coeffs);
+  for (int u = 0; u < 8; u++) {
+    for (int v = 0; v < 8; v++) {
+      std::printf("%.3f\n", coeffs[u][v]);
+    }
+  }
+  return 0;
+}
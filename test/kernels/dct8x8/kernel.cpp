@@ -0,0 +1,18 @@
+// DCT 8x8 of an image block, the nested for shape of the AxDCT operator
+
+void dct8x8(const float block[8][8], const float cosTable[8][8],
+            float coeffs[8][8]) {
+  for (int u = 0; u < 8; u++) {
+    for (int v = 0; v < 8; v++) {
+      float sum = 0.0f;
+      for (int x = 0; x < 8; x++) {
+        for (int y = 0; y < 8; y++) {
+          sum = sum + block[x][y] * cosTable[x][u] * cosTable[y][v];
+        }
+      }
+      float cu = u == 0 ? 0.70710678f : 1.0f;
+      float cv = v == 0 ? 0.70710678f : 1.0f;
+      coeffs[u][v] = 0.25f * cu * cv * sum;
+    }
+  }
+}
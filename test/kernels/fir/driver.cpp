@@ -0,0 +1,37 @@
+// Driver of fir: a sum of two sines with noise through a 16 taps low pass,
+// the filtered samples printed one per line
+
+#include <cmath>
+#include <cstdio>
+
+void fir(const float *signal, int length, const float *taps, int tapCount,
+         float *filtered);
+
+static const double pi = 3.14159265358979323846;
+
+int main() {
+  const int length = 128;
+  const int tapCount = 16;
+  float signal[length];
+  float taps[tapCount];
+  float filtered[length];
+  unsigned seed = 2016;
+  for (int n = 0; n < length; n++) {
+    seed = seed * 1103515245u + 12345u;
+    float noise = (float)((seed >> 16) % 1000) / 1000.0f - 0.5f;
+    signal[n] = (float)(std::sin(n * 0.1) + 0.5 * std::sin(n * 1.3)) +
+                0.2f * noise;
+  }
+  // Hamming windowed sinc
+  for (int k = 0; k < tapCount; k++) {
+    double t = k - (tapCount - 1) / 2.0;
+    double sinc = t == 0 ? 0.25 : std::sin(0.25 * pi * t) / (pi * t);
+    double window = 0.54 - 0.46 * std::cos(2 * pi * k / (tapCount - 1));
+    taps[k] = (float)(sinc * window);
+  }
+  fir(signal, length, taps, tapCount, filtered);
+  for (int n = 0; n < length; n++) {
+    std::printf("%.5f\n", filtered[n]);
+  }
+  return 0;
+}
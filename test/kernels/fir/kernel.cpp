@@ -0,0 +1,14 @@
+// FIR filter of a signal, the samples before the start are zero
+
+void fir(const float *signal, int length, const float *taps, int tapCount,
+         float *filtered) {
+  for (int n = 0; n < length; n++) {
+    float acc = 0.0f;
+    for (int k = 0; k < tapCount; k++) {
+      if (n >= k) {
+        acc = acc + taps[k] * signal[n - k];
+      }
+    }
+    filtered[n] = acc;
+  }
+}
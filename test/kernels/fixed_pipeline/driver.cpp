@@ -0,0 +1,23 @@
+// Driver of fixed_pipeline: a Q8.8 ramp with a square wave and noise, the
+// outputs printed one per line
+
+#include <cstdio>
+
+void fixed_pipeline(const int *samples, int length, int *output);
+
+int main() {
+  const int length = 96;
+  int samples[length];
+  int output[length];
+  unsigned seed = 314;
+  for (int n = 0; n < length; n++) {
+    seed = seed * 1103515245u + 12345u;
+    int square = (n / 8) % 2 == 0 ? 40 * 256 : -40 * 256;
+    samples[n] = n * 64 + square + (int)((seed >> 16) % 512) - 256;
+  }
+  fixed_pipeline(samples, length, output);
+  for (int n = 0; n < length; n++) {
+    std::printf("%d\n", output[n]);
+  }
+  return 0;
+}
@@ -0,0 +1,28 @@
+// Fixed point pipeline on Q8.8 samples: DC removal, 4 taps smoothing, gain
+// and saturation to 16 bits
+
+void fixed_pipeline(const int *samples, int length, int *output) {
+  int mean = 0;
+  for (int n = 0; n < length; n++) {
+    mean = mean + samples[n];
+  }
+  mean = mean / length;
+  int history0 = 0;
+  int history1 = 0;
+  int history2 = 0;
+  for (int n = 0; n < length; n++) {
+    int centered = samples[n] - mean;
+    int smoothed = (centered + history0 + history1 + history2) >> 2;
+    history2 = history1;
+    history1 = history0;
+    history0 = centered;
+    int amplified = (smoothed * 384) >> 8;
+    int biased = amplified + 128;
+    if (biased > 32767) {
+      biased = 32767;
+    } else if (biased < -32768) {
+      biased = -32768;
+    }
+    output[n] = biased;
+  }
+}
@@ -0,0 +1,37 @@
+// Driver of kmeans: 200 points around 4 centers, the centroids printed as
+// "x y" lines followed by the label of each point
+
+#include <cstdio>
+
+void kmeans(const float *points, int count, float *centroids, int k,
+            int iterations, int *labels);
+
+int main() {
+  const int count = 200;
+  const int k = 4;
+  const float centers[k * 2] = {1.0f, 1.0f, 6.0f, 1.5f, 2.0f, 7.0f,
+                                7.0f, 6.0f};
+  float points[count * 2];
+  float centroids[k * 2];
+  int labels[count];
+  unsigned seed = 7;
+  for (int i = 0; i < count; i++) {
+    for (int d = 0; d < 2; d++) {
+      seed = seed * 1103515245u + 12345u;
+      float offset = (float)((seed >> 16) % 2000) / 1000.0f - 1.0f;
+      points[2 * i + d] = centers[2 * (i % k) + d] + 1.5f * offset;
+    }
+  }
+  // The first points as initial centroids
+  for (int c = 0; c < k * 2; c++) {
+    centroids[c] = points[c];
+  }
+  kmeans(points, count, centroids, k, 10, labels);
+  for (int c = 0; c < k; c++) {
+    std::printf("%.4f %.4f\n", centroids[2 * c], centroids[2 * c + 1]);
+  }
+  for (int i = 0; i < count; i++) {
+    std::printf("%d\n", labels[i]);
+  }
+  return 0;
+}
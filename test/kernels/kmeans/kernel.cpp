@@ -0,0 +1,45 @@
+// K-means clustering of 2D points, a fixed number of iterations from the
+// given centroids
+
+void kmeans(const float *points, int count, float *centroids, int k,
+            int iterations, int *labels) {
+  float sums[16 * 2];
+  int members[16];
+  for (int iteration = 0; iteration < iterations; iteration++) {
+    // Assignment
+    for (int i = 0; i < count; i++) {
+      float px = points[2 * i];
+      float py = points[2 * i + 1];
+      int best = 0;
+      float bestDistance = 0.0f;
+      for (int c = 0; c < k; c++) {
+        float dx = px - centroids[2 * c];
+        float dy = py - centroids[2 * c + 1];
+        float distance = dx * dx + dy * dy;
+        if (c == 0 || distance < bestDistance) {
+          best = c;
+          bestDistance = distance;
+        }
+      }
+      labels[i] = best;
+    }
+    // Update
+    for (int c = 0; c < k; c++) {
+      sums[2 * c] = 0.0f;
+      sums[2 * c + 1] = 0.0f;
+      members[c] = 0;
+    }
+    for (int i = 0; i < count; i++) {
+      int c = labels[i];
+      sums[2 * c] = sums[2 * c] + points[2 * i];
+      sums[2 * c + 1] = sums[2 * c + 1] + points[2 * i + 1];
+      members[c]++;
+    }
+    for (int c = 0; c < k; c++) {
+      if (members[c] > 0) {
+        centroids[2 * c] = sums[2 * c] / members[c];
+        centroids[2 * c + 1] = sums[2 * c + 1] / members[c];
+      }
+    }
+  }
+}
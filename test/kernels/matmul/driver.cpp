@@ -0,0 +1,28 @@
+// Driver of matmul: two 12x12 pseudo random matrices, the product printed one
+// row per line
+
+#include <cstdio>
+
+void matmul(const float *a, const float *b, float *c, int n);
+
+int main() {
+  const int n = 12;
+  float a[n * n];
+  float b[n * n];
+  float c[n * n];
+  unsigned seed = 99;
+  for (int i = 0; i < n * n; i++) {
+    seed = seed * 1103515245u + 12345u;
+    a[i] = (float)((seed >> 16) % 200) / 100.0f - 1.0f;
+    seed = seed * 1103515245u + 12345u;
+    b[i] = (float)((seed >> 16) % 200) / 100.0f - 1.0f;
+  }
+  matmul(a, b, c, n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      std::printf(j == 0 ? "%.4f" : " %.4f", c[i * n + j]);
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,34 @@
+// Driver of sobel: a 16x16 image of a bright disc on a gradient with noise,
+// the edges printed one row per line
+
+#include <cstdio>
+
+void sobel(const int *image, int width, int height, int *edges);
+
+int main() {
+  const int width = 16;
+  const int height = 16;
+  int image[width * height];
+  int edges[width * height];
+  unsigned seed = 42;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      seed = seed * 1103515245u + 12345u;
+      int dx = x - 8;
+      int dy = y - 7;
+      int pixel = 4 * x + (int)((seed >> 16) % 16);
+      if (dx * dx + dy * dy < 20) {
+        pixel = pixel + 150;
+      }
+      image[y * width + x] = pixel;
+    }
+  }
+  sobel(image, width, height, edges);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      std::printf(x == 0 ? "%d" : " %d", edges[y * width + x]);
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
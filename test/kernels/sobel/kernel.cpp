@@ -0,0 +1,27 @@
+// Sobel edge magnitude of a gray image, as |gx| + |gy|, the border is zero
+
+void sobel(const int *image, int width, int height, int *edges) {
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      if (y == 0 || x == 0 || y == height - 1 || x == width - 1) {
+        edges[y * width + x] = 0;
+        continue;
+      }
+      const int *row = image + (y - 1) * width + x;
+      int p00 = row[-1];
+      int p01 = row[0];
+      int p02 = row[1];
+      row = row + width;
+      int p10 = row[-1];
+      int p12 = row[1];
+      row = row + width;
+      int p20 = row[-1];
+      int p21 = row[0];
+      int p22 = row[1];
+      int gx = (p02 + 2 * p12 + p22) - (p00 + 2 * p10 + p20);
+      int gy = (p20 + 2 * p21 + p22) - (p00 + 2 * p01 + p02);
+      int magnitude = (gx < 0 ? -gx : gx) + (gy < 0 ? -gy : gy);
+      edges[y * width + x] = magnitude > 255 ? 255 : magnitude;
+    }
+  }
+}
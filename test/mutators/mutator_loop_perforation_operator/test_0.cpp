@@ -0,0 +1,16 @@
+void test_function(int n) {
+  int a[16];
+  for (int i = 0; i < 16; i++) {
+    a[i] = i;
+  }
+  int j;
+  for (j = 0; j < n; j = j + 2) {
+    a[j] = 0;
+  }
+  for (j = 15; j > 0; j = j - 1) {
+    a[j] = a[j - 1];
+  }
+  for (unsigned k = 0; k < 16; k += 4) {
+    a[k] = 1;
+  }
+}
@@ -0,0 +1,19 @@
+void test_function(int n) {
+  int a[16];
+  int j;
+  for (j = 1; j < n; j = j * 2) {
+    a[j] = 0;
+  }
+  for (j = n; j > 1; j = j / 2) {
+    a[j] = 0;
+  }
+  for (j = 1; j < n; j *= 2) {
+    a[j] = 0;
+  }
+  for (j = n; j > 1; j /= 2) {
+    a[j] = 0;
+  }
+  for (j = n; j > 0; j--) {
+    a[j] = 0;
+  }
+}